@@ -32,10 +32,18 @@ extern bool arch_archInit(honggfuzz_t* fuzz);
 
 extern bool arch_archThreadInit(run_t* run);
 
+extern void arch_archThreadDestroy(run_t* run);
+
 extern pid_t arch_fork(run_t* run);
 
 extern void arch_reapChild(run_t* run);
 
+/* Linux only: takes the pidfd of a process forked by this thread with arch_fork(), or returns -1 */
+extern int arch_pidFdTake(pid_t pid);
+
+/* Linux only: waits for any of the running processes, sets done[i] for those which have finished */
+extern void arch_reapChildren(run_t* runs, const bool running[], bool done[], size_t cnt);
+
 extern void arch_prepareParent(run_t* run);
 
 extern void arch_prepareParentAfterFork(run_t* run);
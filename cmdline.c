@@ -126,6 +126,8 @@ static void cmdlineHelp(const char* pname, struct custom_option* opts) {
     LOG_HELP(
         " As above, maximize unique code blocks via Intel Processor Trace (requires libipt.so):");
     LOG_HELP_BOLD("  " PROG_NAME " --linux_perf_ipt_block -- /usr/bin/djpeg " _HF_FILE_PLACEHOLDER);
+    LOG_HELP(" As above, maximize unique code blocks via one-shot breakpoints (no instrumentation):");
+    LOG_HELP_BOLD("  " PROG_NAME " -x --linux_bp_block -- /usr/bin/djpeg " _HF_FILE_PLACEHOLDER);
 #endif /* defined(_HF_ARCH_LINUX) */
 }
 
@@ -200,6 +202,34 @@ rlim_t cmdlineParseRLimit(int res, const char* optarg, unsigned long mul) {
     return val;
 }
 
+/* Splits the value of --sanitizer_cmdline into arguments separated by spaces or tabs */
+static bool cmdlineParseSanitizerCmdline(honggfuzz_t* hfuzz, const char* optarg) {
+    char* str = util_StrDup(optarg);
+    const char** args = (const char**)util_Calloc((_HF_ARGS_MAX + 1) * sizeof(char*));
+    int argc = 0;
+
+    char* saveptr = NULL;
+    for (char* arg = strtok_r(str, " \t", &saveptr); arg; arg = strtok_r(NULL, " \t", &saveptr)) {
+        if (argc == _HF_ARGS_MAX) {
+            LOG_E("Too many arguments in '%s' (max: %d)", optarg, _HF_ARGS_MAX);
+            free(args);
+            free(str);
+            return false;
+        }
+        args[argc++] = arg;
+    }
+    if (argc == 0) {
+        LOG_E("Empty sanitizer build command line provided");
+        free(args);
+        free(str);
+        return false;
+    }
+
+    hfuzz->sanitizer.argc = argc;
+    hfuzz->sanitizer.cmdline = args;
+    return true;
+}
+
 static bool cmdlineVerify(honggfuzz_t* hfuzz) {
     if (!cmdlineCheckBinaryType(hfuzz)) {
         LOG_E("Couldn't test binary for signatures");
@@ -213,6 +243,29 @@ static bool cmdlineVerify(honggfuzz_t* hfuzz) {
         return false;
     }
 
+    if (hfuzz->sanitizer.argc) {
+        if (!files_exists(hfuzz->sanitizer.cmdline[0])) {
+            LOG_E("The sanitizer build '%s' doesn't seem to exist", hfuzz->sanitizer.cmdline[0]);
+            return false;
+        }
+        if (!hfuzz->exe.fuzzStdin && !hfuzz->exe.persistent &&
+            !checkFor_FILE_PLACEHOLDER(hfuzz->sanitizer.cmdline)) {
+            LOG_E("You must specify '" _HF_FILE_PLACEHOLDER "' in the sanitizer build command line "
+                  "if the -s (stdin fuzzing) or --persistent options are not set");
+            return false;
+        }
+        if (hfuzz->cfg.useVerifier || hfuzz->socketFuzzer.enabled) {
+            LOG_E("The sanitizer build can't be used with the crash verifier or the socket fuzzer");
+            return false;
+        }
+    }
+
+    /* Inputs are sent by the external fuzzer, so there's nothing to re-run crashes with */
+    if (hfuzz->cfg.useVerifier && hfuzz->socketFuzzer.enabled) {
+        LOG_W("The crash verifier is not used with the socket fuzzer, crashes are saved unverified");
+        hfuzz->cfg.useVerifier = false;
+    }
+
     if (hfuzz->threads.threadsMax >= _HF_THREAD_MAX) {
         LOG_E("Too many fuzzing threads specified %zu (>= _HF_THREAD_MAX (%u))",
             hfuzz->threads.threadsMax, _HF_THREAD_MAX);
@@ -222,6 +275,75 @@ static bool cmdlineVerify(honggfuzz_t* hfuzz) {
         LOG_E("Too few fuzzing threads specified: %zu", hfuzz->threads.threadsMax);
         return false;
     }
+    if (hfuzz->threads.childrenPerThread == 0) {
+        LOG_E("Too few processes per fuzzing thread specified: %zu",
+            hfuzz->threads.childrenPerThread);
+        return false;
+    }
+    /*
+     * Every fuzzed process (incl. the ones of the verifier threads) needs its own slot in the
+     * feedback structure. The sanitizer build doesn't use the feedback structure at all
+     */
+    size_t extraProcs = hfuzz->cfg.useVerifier ? _HF_VERIFIER_THREADS : 0;
+    if ((hfuzz->threads.threadsMax * hfuzz->threads.childrenPerThread) >=
+        (_HF_THREAD_MAX - extraProcs)) {
+        LOG_E("Too many fuzzed processes specified %zu*%zu+%zu (>= _HF_THREAD_MAX (%u))",
+            hfuzz->threads.threadsMax, hfuzz->threads.childrenPerThread, extraProcs,
+            _HF_THREAD_MAX);
+        return false;
+    }
+    if (hfuzz->threads.childrenPerThread > 1 && hfuzz->socketFuzzer.enabled) {
+        LOG_E("The socket fuzzer requires one process per fuzzing thread");
+        return false;
+    }
+    if ((hfuzz->exe.persistentMaxRss || hfuzz->exe.persistentMaxSlowdown) &&
+        !hfuzz->exe.persistent) {
+        LOG_E("--persistent_max_rss and --persistent_max_slowdown require the persistent mode (-P)");
+        return false;
+    }
+    if (hfuzz->exe.persistentWatchdog && (!hfuzz->exe.persistent || !hfuzz->timing.tmOut)) {
+        LOG_E("--persistent_watchdog requires the persistent mode (-P) and a timeout (-t)");
+        return false;
+    }
+    if (hfuzz->exe.persistentWatchdog && hfuzz->timing.tmoutVTALRM) {
+        LOG_E("--persistent_watchdog can't be used with -T (--tmout_sigvtalrm): inputs stopped by "
+              "the watchdog are not saved as crashes");
+        return false;
+    }
+    if (hfuzz->mutate.childMangle && !hfuzz->exe.persistent) {
+        LOG_E("--persistent_mangle requires the persistent mode (-P)");
+        return false;
+    }
+#if !defined(_HF_ARCH_LINUX)
+    if (hfuzz->exe.persistentMaxRss) {
+        LOG_E("--persistent_max_rss is supported under Linux only");
+        return false;
+    }
+#endif /* !defined(_HF_ARCH_LINUX) */
+    if (hfuzz->replay.enabled && (hfuzz->cfg.minimize || hfuzz->socketFuzzer.enabled)) {
+        LOG_E("The replay mode (--replay) can't be used with --minimize or the socket fuzzer");
+        return false;
+    }
+#if defined(_HF_ARCH_LINUX)
+    if (hfuzz->linux.useSnapshot && !hfuzz->exe.persistent) {
+        LOG_E("The snapshot mode (--linux_snapshot) requires the persistent mode (-P)");
+        return false;
+    }
+    if (hfuzz->linux.spareChildren > _HF_SPARES_MAX) {
+        LOG_E("Too many spare processes (--linux_spare_children) specified: %zu (> %d)",
+            hfuzz->linux.spareChildren, _HF_SPARES_MAX);
+        return false;
+    }
+    if (hfuzz->linux.spareChildren && hfuzz->threads.childrenPerThread > 1) {
+        LOG_E("Spare processes (--linux_spare_children) can't be used with "
+              "--linux_children_per_thread > 1");
+        return false;
+    }
+    if ((hfuzz->linux.cgroupPidsMax || hfuzz->linux.cgroupCpuPct) && !hfuzz->linux.cgroupDir) {
+        LOG_E("--linux_cgroup_pids and --linux_cgroup_cpu require --linux_cgroup");
+        return false;
+    }
+#endif /* defined(_HF_ARCH_LINUX) */
 
     if (strchr(hfuzz->io.fileExtn, '/')) {
         LOG_E("The file extension contains the '/' character: '%s'", hfuzz->io.fileExtn);
@@ -269,6 +391,7 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                     (ncpus <= 1 ? 1 : ncpus / 2);
                 }),
                 .threadsActiveCnt = 0,
+                .childrenPerThread = 1,
                 .mainThread = pthread_self(),
                 .mainPid = getpid(),
             },
@@ -292,6 +415,10 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .dynfileqCurrent = NULL,
                 .dynfileq2Current = NULL,
                 .exportFeedback = false,
+                .preload = false,
+                .preloaded = NULL,
+                .preloadedCnt = 0,
+                .preloadedCurrent = 0,
             },
         .exe =
             {
@@ -303,6 +430,9 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .postExternalCommand = NULL,
                 .feedbackMutateCommand = NULL,
                 .persistent = false,
+                .persistentMaxRss = 0,
+                .persistentMaxSlowdown = 0,
+                .persistentWatchdog = false,
                 .netDriver = false,
                 .asLimit = 0U,
                 .rssLimit = 0U,
@@ -329,6 +459,18 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .dictionaryFile = NULL,
                 .mutationsPerRun = 5,
                 .maxInputSz = 0,
+                .fixupFields = false,
+                .mutateTokens = false,
+                .spliceAligned = false,
+                .childMangle = false,
+                .corpusFd = -1,
+                .corpusMap = NULL,
+                .corpusUsed = 0,
+                .tokens =
+                    {
+                        .usedCnt = 0,
+                        .rwlock = PTHREAD_RWLOCK_INITIALIZER,
+                    },
             },
         .display =
             {
@@ -351,6 +493,17 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             {
                 .enable = false,
                 .del_report = false,
+                .argc = 0,
+                .cmdline = NULL,
+                .queue_mutex = PTHREAD_MUTEX_INITIALIZER,
+                .queue_cond = PTHREAD_COND_INITIALIZER,
+                .queueCnt = 0,
+            },
+        .verifier =
+            {
+                .threadsActiveCnt = 0,
+                .queue_mutex = PTHREAD_MUTEX_INITIALIZER,
+                .queue_cond = PTHREAD_COND_INITIALIZER,
             },
         .feedback =
             {
@@ -360,6 +513,7 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .cmpFeedbackMap = NULL,
                 .cmpFeedbackFd = -1,
                 .cmpFeedback = true,
+                .ctxCov = false,
                 .blacklistFile = NULL,
                 .blacklist = NULL,
                 .blacklistCnt = 0,
@@ -382,6 +536,14 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .serverSocket = -1,
                 .clientSocket = -1,
             },
+        .replay =
+            {
+                .enabled = false,
+                .resultsFile = NULL,
+                .results_mutex = PTHREAD_MUTEX_INITIALIZER,
+                .results = NULL,
+                .resultsCnt = 0,
+            },
 
         /* Linux code */
         .linux =
@@ -408,6 +570,18 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
                 .cloneFlags = 0,
                 .kernelOnly = false,
                 .useClone = true,
+                .useSnapshot = false,
+                .spareChildren = 0,
+                .cgroupDir = NULL,
+                .cgroupPidsMax = 0,
+                .cgroupCpuPct = 0,
+                .bp =
+                    {
+                        .blocks = NULL,
+                        .blocksCnt = 0,
+                        .hitMap = NULL,
+                        .loadVma = 0,
+                    },
             },
         /* NetBSD code */
         .netbsd =
@@ -423,6 +597,8 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
     };
 
     TAILQ_INIT(&hfuzz->io.dynfileq);
+    TAILQ_INIT(&hfuzz->sanitizer.queue);
+    TAILQ_INIT(&hfuzz->verifier.queue);
 
     // clang-format off
     struct custom_option custom_opts[] = {
@@ -430,8 +606,13 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
         { { "input", required_argument, NULL, 'i' }, "Path to a directory containing initial file corpus" },
         { { "output", required_argument, NULL, 'o' }, "Output data (new dynamic coverage corpus, or the minimized coverage corpus) is written to this directory (default: input directory is re-used)" },
         { { "persistent", no_argument, NULL, 'P' }, "Enable persistent fuzzing (use hfuzz_cc/hfuzz-clang to compile code). This will be auto-detected!!!" },
+        { { "persistent_max_rss", required_argument, NULL, 0x118 }, "Restart the persistent process once its RSS grows above this many MiB (default: 0 [no limit]). Inputs which make the RSS grow by more than 1MiB in one run are saved in the workspace as MEMGROWTH.* (Linux only)" },
+        { { "persistent_max_slowdown", required_argument, NULL, 0x119 }, "Restart the persistent process once its average time per input grows this many times over the one measured right after it was started (default: 0 [never])" },
+        { { "persistent_watchdog", no_argument, NULL, 0x11D }, "Let the persistent process abort inputs running longer than the timeout (-t) by itself (with SIGALRM and siglongjmp()), instead of being killed and restarted. It's killed only if that doesn't work within 1s. Can't be used with -T" },
+        { { "persistent_mangle", no_argument, NULL, 0x11E }, "Let the persistent process mutate inputs itself: the corpus is shared with it read-only, and only the location of a seed input and a PRNG seed are sent per input. Inputs are re-created by honggfuzz only if they are interesting (byte-level mutations only)" },
         { { "instrument", no_argument, NULL, 'z' }, "*DEFAULT-MODE-BY-DEFAULT* Enable compile-time instrumentation (use hfuzz_cc/hfuzz-clang to compile code)" },
         { { "minimize", no_argument, NULL, 'M' }, "Minimize the input corpus. It will most likely delete some corpus files (from the --input directory) if no --output is used!" },
+        { { "replay", required_argument, NULL, 0x117 }, "Run every file from the input corpus exactly once (no mutations, no new corpus files), write per-file results (exec time, crash/timeout status) to this file ('-' for stdout), print a coverage summary and exit. The exit code is non-zero if any input crashed or timed out" },
         { { "noinst", no_argument, NULL, 'x' }, "Static mode only, disable any instrumentation (hw/sw) feedback" },
         { { "keep_output", no_argument, NULL, 'Q' }, "Don't close children's stdin, stdout, stderr; can be noisy" },
         { { "timeout", required_argument, NULL, 't' }, "Timeout in seconds (default: 10)" },
@@ -461,20 +642,26 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
         { { "rlimit_core", required_argument, NULL, 0x103 }, "Per process RLIMIT_CORE in MiB (default: 0 [no cores are produced])" },
         { { "rlimit_stack", required_argument, NULL, 0x104 }, "Per process RLIMIT_STACK in MiB (default: 0 [default limit])" },
         { { "report", required_argument, NULL, 'R' }, "Write report to this file (default: '<workdir>/" _HF_REPORT_FILE "')" },
-        { { "max_file_size", required_argument, NULL, 'F' }, "Maximal size of files processed by the fuzzer in bytes (default: 134217728 = 128MB)" },
+        { { "max_file_size", required_argument, NULL, 'F' }, "Maximal size of files processed by the fuzzer in bytes (default: 1073741824 = 1GiB)" },
         { { "clear_env", no_argument, NULL, 0x108 }, "Clear all environment variables before executing the binary" },
         { { "env", required_argument, NULL, 'E' }, "Pass this environment variable, can be used multiple times" },
         { { "save_all", no_argument, NULL, 'u' }, "Save all test-cases (not only the unique ones) by appending the current time-stamp to the filenames" },
         { { "tmout_sigvtalrm", no_argument, NULL, 'T' }, "Use SIGVTALRM to kill timeouting processes (default: use SIGKILL)" },
         { { "sanitizers", no_argument, NULL, 'S' }, "** DEPRECATED ** Enable sanitizers settings (default: false)" },
         { { "sanitizers_del_report", required_argument, NULL, 0x10F }, "Delete sanitizer report after use (default: false)" },
+        { { "sanitizer_cmdline", required_argument, NULL, 0x114 }, "Command line of a sanitizer build of the fuzzed binary (space-separated). Crashes and new inputs found with the main binary are re-run with it, and only crashes confirmed by it are saved" },
         { { "monitor_sigabrt", required_argument, NULL, 0x105 }, "** DEPRECATED ** SIGABRT is always monitored" },
         { { "no_fb_timeout", required_argument, NULL, 0x106 }, "Skip feedback if the process has timeouted (default: false)" },
         { { "exit_upon_crash", no_argument, NULL, 0x107 }, "Exit upon seeing the first crash (default: false)" },
         { { "socket_fuzzer", no_argument, NULL, 0x10B }, "Instrument external fuzzer via socket" },
         { { "netdriver", no_argument, NULL, 0x10C }, "Use netdriver (libhfnetdriver/). In most cases it will be autodetected through a binary signature" },
         { { "only_printable", no_argument, NULL, 0x10D }, "Only generate printable inputs" },
+        { { "mutate_tokens", no_argument, NULL, 0x11B }, "Split corpus inputs into tokens (words, punctuation, whitespace), and mutate half of the inputs by swapping, duplicating, deleting or replacing tokens (with ones frequently seen in the corpus). Useful for text formats and source code" },
+        { { "splice_aligned", no_argument, NULL, 0x11C }, "Splice inputs with others of similar code coverage, at points where both share a common 4-byte substring, or right after their common leading bytes" },
         { { "export_feedback", no_argument, NULL, 0x10E }, "Export the coverage feedback structure as ./hfuzz-feedback" },
+        { { "preload_input", no_argument, NULL, 0x113 }, "Read the whole input corpus into memory (with parallel readers) before fuzzing starts" },
+        { { "fixup_fields", no_argument, NULL, 0x11A }, "Find length (relative to EOF) and CRC-32 fields in corpus inputs, by matching them with operands of comparisons in the target, and keep them consistent with the rest of the input after mutations" },
+        { { "context_cov", no_argument, NULL, 0x11F }, "Count edges separately for each calling context (a hash of the functions on the call stack), so that inputs reaching known code from new callers are kept. Needs targets compiled with HFUZZ_CC_CONTEXT set in the environment" },
         { { "const_feedback", required_argument, NULL, 0x112 }, "Use constant integer/string values from fuzzed programs to mangle input files via a dynamic dictionary (default: true)" },
 
 #if defined(_HF_ARCH_LINUX)
@@ -488,9 +675,16 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
         { { "linux_perf_bts_edge", no_argument, NULL, 0x513 }, "Use Intel BTS to count unique edges" },
         { { "linux_perf_ipt_block", no_argument, NULL, 0x514 }, "Use Intel Processor Trace to count unique blocks (requires libipt.so)" },
         { { "linux_perf_kernel_only", no_argument, NULL, 0x515 }, "Gather kernel-only coverage with Intel PT and with Intel BTS" },
+        { { "linux_bp_block", no_argument, NULL, 0x516 }, "Count unique blocks with one-shot breakpoints placed at blocks found by disassembling the binary (x86/x86-64, no instrumentation or CPU support required)" },
         { { "linux_ns_net", no_argument, NULL, 0x0530 }, "Use Linux NET namespace isolation" },
         { { "linux_ns_pid", no_argument, NULL, 0x0531 }, "Use Linux PID namespace isolation" },
         { { "linux_ns_ipc", no_argument, NULL, 0x0532 }, "Use Linux IPC namespace isolation" },
+        { { "linux_children_per_thread", required_argument, NULL, 0x0533 }, "Number of fuzzed processes driven by a single fuzzing thread with an epoll loop (default: 1)" },
+        { { "linux_snapshot", no_argument, NULL, 0x0534 }, "Restore memory of persistent-mode targets to its post-initialization state after each input (requires -P)" },
+        { { "linux_spare_children", required_argument, NULL, 0x0535 }, "Number of processes kept forked in advance by each fuzzing thread, waiting for the input to be passed to them right before execve() (non-persistent mode only, max: 8, default: 0)" },
+        { { "linux_cgroup", required_argument, NULL, 0x0536 }, "Run each fuzzed process in its own cgroup (v2), created under this (delegated) cgroup directory. Its memory.max is set with --rlimit_rss, processes left behind are killed with cgroup.kill after each run, and memory.peak is included in crash reports" },
+        { { "linux_cgroup_pids", required_argument, NULL, 0x0537 }, "pids.max of cgroups created with --linux_cgroup (default: 0 [no limit])" },
+        { { "linux_cgroup_cpu", required_argument, NULL, 0x0538 }, "CPU quota (cpu.max) of cgroups created with --linux_cgroup, in percent of a single CPU (default: 0 [no limit])" },
 #endif // defined(_HF_ARCH_LINUX)
 
 #if defined(_HF_ARCH_NETBSD)
@@ -580,6 +774,11 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 0x10F:
                 hfuzz->sanitizer.del_report = cmdlineParseTrueFalse(opts[opt_index].name, optarg);
                 break;
+            case 0x114:
+                if (!cmdlineParseSanitizerCmdline(hfuzz, optarg)) {
+                    return false;
+                }
+                break;
             case 0x10B:
                 hfuzz->socketFuzzer.enabled = true;
                 hfuzz->timing.tmOut = 0; /* Disable process timeout checks */
@@ -593,6 +792,21 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 0x10E:
                 hfuzz->io.exportFeedback = true;
                 break;
+            case 0x113:
+                hfuzz->io.preload = true;
+                break;
+            case 0x11A:
+                hfuzz->mutate.fixupFields = true;
+                break;
+            case 0x11B:
+                hfuzz->mutate.mutateTokens = true;
+                break;
+            case 0x11C:
+                hfuzz->mutate.spliceAligned = true;
+                break;
+            case 0x11F:
+                hfuzz->feedback.ctxCov = true;
+                break;
             case 0x112:
                 hfuzz->feedback.cmpFeedback = cmdlineParseTrueFalse(opts[opt_index].name, optarg);
                 break;
@@ -602,6 +816,10 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 'M':
                 hfuzz->cfg.minimize = true;
                 break;
+            case 0x117:
+                hfuzz->replay.enabled = true;
+                hfuzz->replay.resultsFile = optarg;
+                break;
             case 'F':
                 hfuzz->io.maxFileSz = strtoul(optarg, NULL, 0);
                 break;
@@ -665,6 +883,18 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 'P':
                 hfuzz->exe.persistent = true;
                 break;
+            case 0x118:
+                hfuzz->exe.persistentMaxRss = strtoull(optarg, NULL, 0);
+                break;
+            case 0x119:
+                hfuzz->exe.persistentMaxSlowdown = (unsigned)strtoul(optarg, NULL, 0);
+                break;
+            case 0x11D:
+                hfuzz->exe.persistentWatchdog = true;
+                break;
+            case 0x11E:
+                hfuzz->mutate.childMangle = true;
+                break;
             case 'T':
                 hfuzz->timing.tmoutVTALRM = true;
                 break;
@@ -710,6 +940,9 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 0x515:
                 hfuzz->linux.kernelOnly = true;
                 break;
+            case 0x516:
+                hfuzz->feedback.dynFileMethod |= _HF_DYNFILE_BP_BLOCK;
+                break;
             case 0x530:
                 hfuzz->linux.cloneFlags |= (CLONE_NEWUSER | CLONE_NEWNET);
                 break;
@@ -719,6 +952,24 @@ bool cmdlineParse(int argc, char* argv[], honggfuzz_t* hfuzz) {
             case 0x532:
                 hfuzz->linux.cloneFlags |= (CLONE_NEWUSER | CLONE_NEWIPC);
                 break;
+            case 0x533:
+                hfuzz->threads.childrenPerThread = strtoul(optarg, NULL, 0);
+                break;
+            case 0x534:
+                hfuzz->linux.useSnapshot = true;
+                break;
+            case 0x535:
+                hfuzz->linux.spareChildren = strtoul(optarg, NULL, 0);
+                break;
+            case 0x536:
+                hfuzz->linux.cgroupDir = optarg;
+                break;
+            case 0x537:
+                hfuzz->linux.cgroupPidsMax = strtoull(optarg, NULL, 0);
+                break;
+            case 0x538:
+                hfuzz->linux.cgroupCpuPct = strtoull(optarg, NULL, 0);
+                break;
 #endif /* defined(_HF_ARCH_LINUX) */
 #if defined(_HF_ARCH_NETBSD)
             case 0x500:
@@ -255,9 +255,13 @@ void display_display(honggfuzz_t* hfuzz) {
         hfuzz->threads.threadsMax, num_cpu, cpuUse, cpuUse / num_cpu);
 
     size_t tot_exec_per_sec = elapsed_sec ? (curr_exec_cnt / elapsed_sec) : 0;
+    size_t dup_skipped_cnt = ATOMIC_GET(hfuzz->cnts.dupSkippedCnt);
+    unsigned dup_skipped_pct =
+        curr_exec_cnt ? (unsigned)((dup_skipped_cnt * 100) / (curr_exec_cnt + dup_skipped_cnt)) : 0;
     display_put("       Speed : " ESC_BOLD "%" _HF_NONMON_SEP "zu" ESC_RESET "/sec [avg: " ESC_BOLD
-                "%" _HF_NONMON_SEP "zu" ESC_RESET "]\n",
-        exec_per_millis, tot_exec_per_sec);
+                "%" _HF_NONMON_SEP "zu" ESC_RESET ", dups skipped: " ESC_BOLD "%u" ESC_RESET
+                "%%]\n",
+        exec_per_millis, tot_exec_per_sec, dup_skipped_pct);
 
     uint64_t crashesCnt = ATOMIC_GET(hfuzz->cnts.crashesCnt);
     /* colored the crash count as red when exist crash */
@@ -267,8 +271,18 @@ void display_display(honggfuzz_t* hfuzz) {
         crashesCnt > 0 ? ESC_RED : "", hfuzz->cnts.crashesCnt, crashesCnt > 0 ? ESC_RED : "",
         ATOMIC_GET(hfuzz->cnts.uniqueCrashesCnt), ATOMIC_GET(hfuzz->cnts.blCrashesCnt),
         ATOMIC_GET(hfuzz->cnts.verifiedCrashesCnt));
+    if (hfuzz->sanitizer.argc) {
+        display_put("   Sanitizer : " ESC_BOLD "%zu" ESC_RESET " queued, unconfirmed crashes: " ESC_BOLD
+                    "%zu" ESC_RESET "\n",
+            ATOMIC_GET(hfuzz->sanitizer.queueCnt), ATOMIC_GET(hfuzz->cnts.sanUnconfirmedCnt));
+    }
     display_put("    Timeouts : " ESC_BOLD "%" _HF_NONMON_SEP "zu" ESC_RESET " [%lu sec]\n",
         ATOMIC_GET(hfuzz->cnts.timeoutedCnt), (unsigned long)hfuzz->timing.tmOut);
+    if (hfuzz->exe.persistentMaxRss || hfuzz->exe.persistentMaxSlowdown) {
+        display_put("    Recycled : " ESC_BOLD "%" _HF_NONMON_SEP "zu" ESC_RESET
+                    " persistent processes\n",
+            ATOMIC_GET(hfuzz->cnts.recycledCnt));
+    }
     /* Feedback data sources. Common headers. */
     display_put(" Corpus Size : " ESC_BOLD "%" _HF_NONMON_SEP "zu" ESC_RESET ", max: " ESC_BOLD
                 "%" _HF_NONMON_SEP "zu" ESC_RESET " bytes, init: " ESC_BOLD "%" _HF_NONMON_SEP
@@ -297,6 +311,10 @@ void display_display(honggfuzz_t* hfuzz) {
         display_put(" ipt: " ESC_BOLD "%" _HF_NONMON_SEP PRIu64 ESC_RESET,
             ATOMIC_GET(hfuzz->linux.hwCnts.bbCnt));
     }
+    if (hfuzz->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK) {
+        display_put(" bp: " ESC_BOLD "%" _HF_NONMON_SEP PRIu64 ESC_RESET "/%zu",
+            ATOMIC_GET(hfuzz->linux.hwCnts.bbCnt), hfuzz->linux.bp.blocksCnt);
+    }
     if (hfuzz->feedback.dynFileMethod & _HF_DYNFILE_SOFT) {
         uint64_t softCntPc = ATOMIC_GET(hfuzz->linux.hwCnts.softCntPc);
         uint64_t softCntEdge = ATOMIC_GET(hfuzz->linux.hwCnts.softCntEdge);
@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# Compares the default and the fast (HFUZZ_CC_FAST) instrumentation profiles of hfuzz-cc: builds
+# the target with both, fuzzes each build for the same time, and reports exec/s and coverage growth.
+#
+# Coverage of both profiles is measured by replaying their corpora (as they were after 1/4, 1/2,
+# 3/4 and all of the run time) against the default build, as guard/PC counts of differently
+# optimized builds can't be compared directly
+#
+# Usage: compare-cc-profiles.sh SECONDS CORPUS_DIR SOURCE [compiler/linker args...]
+#   CC          - hfuzz-cc wrapper to use (default: hfuzz_cc/hfuzz-clang)
+#   TARGET_ARGS - target args (e.g. '___FILE___' for targets reading a file)
+#   THREADS     - fuzzing threads per run (default: 1)
+
+set -e
+
+if [ $# -lt 3 ]; then
+	echo "$0" SECONDS CORPUS_DIR SOURCE [compiler/linker args...]
+	exit 1
+fi
+
+SECS="$1"
+CORPUS="$2"
+shift 2
+
+HFUZZ_SRC=`cd "\`dirname "$0"\`/../.." && pwd`
+CC="${CC:-$HFUZZ_SRC/hfuzz_cc/hfuzz-clang}"
+THREADS="${THREADS:-1}"
+WORK=`mktemp -d`
+
+for PROFILE in default fast; do
+	if [ "$PROFILE" = "fast" ]; then
+		HFUZZ_CC_FAST=1 "$CC" -O2 -g -o "$WORK/target.$PROFILE" "$@"
+	else
+		"$CC" -O2 -g -o "$WORK/target.$PROFILE" "$@"
+	fi
+done
+
+printf "%-8s %10s %12s %12s %12s %12s\n" profile exec/s cov@25% cov@50% cov@75% cov@100%
+for PROFILE in default fast; do
+	mkdir -p "$WORK/out.$PROFILE" "$WORK/ws.$PROFILE"
+	START=`date +%s`
+	"$HFUZZ_SRC/honggfuzz" -n "$THREADS" --run_time "$SECS" -i "$CORPUS" \
+		--output "$WORK/out.$PROFILE" -W "$WORK/ws.$PROFILE" -l "$WORK/log.$PROFILE" \
+		-- "$WORK/target.$PROFILE" $TARGET_ARGS || true
+	SPEED=`grep -o 'speed:[0-9]*' "$WORK/log.$PROFILE" | tail -n1 | cut -d: -f2`
+
+	COV=""
+	for PART in 1 2 3 4; do
+		SNAP="$WORK/snap.$PROFILE.$PART"
+		mkdir -p "$SNAP"
+		cp "$CORPUS"/* "$SNAP/" 2>/dev/null || true
+		find "$WORK/out.$PROFILE" -type f ! -newermt "@$((START + SECS * PART / 4))" \
+			-exec cp {} "$SNAP/" \;
+		"$HFUZZ_SRC/honggfuzz" -n "$THREADS" --replay /dev/null -i "$SNAP" \
+			-W "$WORK/ws.$PROFILE" -l "$WORK/replay.$PROFILE.$PART" \
+			-- "$WORK/target.default" $TARGET_ARGS || true
+		# Edges (trace-pc-guard) and PCs (trace-pc), whichever is used by the compiler
+		EP=`grep -o 'coverage (i/b/h/e/p/c): [0-9/]*' "$WORK/replay.$PROFILE.$PART" | \
+			tail -n1 | cut -d' ' -f3 | cut -d/ -f4,5`
+		COV="$COV `echo "$EP" | awk -F/ '{ print $1 + $2 }'`"
+	done
+	printf "%-8s %10s %12s %12s %12s %12s\n" "$PROFILE" "$SPEED" $COV
+done
+
+rm -rf "$WORK"
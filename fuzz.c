@@ -185,6 +185,60 @@ static void fuzz_minimizeRemoveFiles(run_t* run) {
     LOG_I("Corpus minimization done");
 }
 
+/* Waits (with the mutex held) up to 100ms for the condition to be signaled */
+static void fuzz_queueWait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (1000ULL * 1000ULL * 100ULL);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, mutex, &ts);
+}
+
+/* Queues a copy of the current input, to be re-run with the sanitizer build of the target */
+static void fuzz_sanitizerEnqueue(run_t* run, bool crashed) {
+    honggfuzz_t* hfuzz = run->global;
+
+    MX_SCOPED_LOCK(&hfuzz->sanitizer.queue_mutex);
+    if (hfuzz->sanitizer.queueCnt >= _HF_SANITIZER_QUEUE_MAX) {
+        LOG_W("The sanitizer build queue is full (%zu inputs), skipping an input of size %zu",
+            hfuzz->sanitizer.queueCnt, run->dynfile->size);
+        return;
+    }
+
+    input_syncChildMutation(run);
+    sanInput_t* in = (sanInput_t*)util_Malloc(sizeof(sanInput_t));
+    in->data = (uint8_t*)util_Malloc(run->dynfile->size + 1);
+    memcpy(in->data, run->dynfile->data, run->dynfile->size);
+    in->size = run->dynfile->size;
+    in->crashed = crashed;
+    /* Potential crashes go first */
+    if (crashed) {
+        TAILQ_INSERT_HEAD(&hfuzz->sanitizer.queue, in, pointers);
+    } else {
+        TAILQ_INSERT_TAIL(&hfuzz->sanitizer.queue, in, pointers);
+    }
+    hfuzz->sanitizer.queueCnt++;
+    pthread_cond_signal(&hfuzz->sanitizer.queue_cond);
+}
+
+/* Waits up to 100ms for an input in the sanitizer build queue */
+static sanInput_t* fuzz_sanitizerDequeue(honggfuzz_t* hfuzz) {
+    MX_SCOPED_LOCK(&hfuzz->sanitizer.queue_mutex);
+    if (TAILQ_EMPTY(&hfuzz->sanitizer.queue)) {
+        fuzz_queueWait(&hfuzz->sanitizer.queue_cond, &hfuzz->sanitizer.queue_mutex);
+    }
+
+    sanInput_t* in = TAILQ_FIRST(&hfuzz->sanitizer.queue);
+    if (in) {
+        TAILQ_REMOVE(&hfuzz->sanitizer.queue, in, pointers);
+        hfuzz->sanitizer.queueCnt--;
+    }
+    return in;
+}
+
 static void fuzz_perfFeedback(run_t* run) {
     if (run->global->feedback.skipFeedbackOnTimeout && run->tmOutSignaled) {
         return;
@@ -211,6 +265,7 @@ static void fuzz_perfFeedback(run_t* run) {
     /* Any increase in coverage (edge, pc, cmp, hw) counters forces adding input to the corpus */
     if (run->linux.hwCnts.newBBCnt > 0 || softCntPc > 0 || softCntEdge > 0 || softCntCmp > 0 ||
         diff0 < 0 || diff1 < 0) {
+        input_syncChildMutation(run);
         if (diff0 < 0) {
             run->global->linux.hwCnts.cpuInstrCnt = run->linux.hwCnts.cpuInstrCnt;
         }
@@ -232,7 +287,14 @@ static void fuzz_perfFeedback(run_t* run) {
             run->global->linux.hwCnts.bbCnt, run->global->linux.hwCnts.softCntEdge,
             run->global->linux.hwCnts.softCntPc, run->global->linux.hwCnts.softCntCmp);
 
-        input_addDynamicInput(run);
+        /* The replay mode only measures the coverage, the corpus stays untouched */
+        if (!run->global->replay.enabled) {
+            input_addDynamicInput(run);
+        }
+        /* Crashing inputs are queued for the sanitizer build in fuzz_runFinish() anyway */
+        if (run->global->sanitizer.argc && !run->backtrace) {
+            fuzz_sanitizerEnqueue(run, /* crashed= */ false);
+        }
 
         if (run->global->socketFuzzer.enabled) {
             LOG_D("SocketFuzzer: fuzz: new BB (perf)");
@@ -241,76 +303,172 @@ static void fuzz_perfFeedback(run_t* run) {
     }
 }
 
-/* Return value indicates whether report file should be updated with the current verified crash */
-static bool fuzz_runVerifier(run_t* run) {
+/*
+ * Queues the current crash to be re-run by the verifier threads. Return value indicates whether
+ * report file should be updated with the current crash
+ */
+static bool fuzz_verifierEnqueue(run_t* run) {
     if (!run->crashFileName[0] || !run->backtrace) {
         return false;
     }
 
-    uint64_t backtrace = run->backtrace;
-
-    char origCrashPath[PATH_MAX];
-    snprintf(origCrashPath, sizeof(origCrashPath), "%s", run->crashFileName);
     /* Workspace is inherited, just append a extra suffix */
     char verFile[PATH_MAX];
-    snprintf(verFile, sizeof(verFile), "%s.verified", origCrashPath);
-
+    snprintf(verFile, sizeof(verFile), "%s.verified", run->crashFileName);
     if (files_exists(verFile)) {
-        LOG_D("Crash file to verify '%s' is already verified as '%s'", origCrashPath, verFile);
+        LOG_D("Crash file to verify '%s' is already verified as '%s'", run->crashFileName, verFile);
         return false;
     }
 
-    for (int i = 0; i < _HF_VERIFIER_ITER; i++) {
-        LOG_I("Launching verifier for HASH: %" PRIx64 " (iteration: %d out of %d)", run->backtrace,
-            i + 1, _HF_VERIFIER_ITER);
-        run->timeStartedMillis = util_timeNowMillis();
-        run->backtrace = 0;
-        run->access = 0;
-        run->exception = 0;
-        run->mainWorker = false;
+    input_syncChildMutation(run);
+    verifyJob_t* job = (verifyJob_t*)util_Calloc(sizeof(verifyJob_t));
+    job->data = (uint8_t*)util_Malloc(run->dynfile->size + 1);
+    memcpy(job->data, run->dynfile->data, run->dynfile->size);
+    job->size = run->dynfile->size;
+    job->backtrace = run->backtrace;
+    snprintf(job->crashFileName, sizeof(job->crashFileName), "%s", run->crashFileName);
+    job->queued = true;
 
-        if (!subproc_Run(run)) {
-            LOG_F("subproc_Run()");
-        }
+    MX_SCOPED_LOCK(&run->global->verifier.queue_mutex);
+    TAILQ_INSERT_TAIL(&run->global->verifier.queue, job, pointers);
+    pthread_cond_broadcast(&run->global->verifier.queue_cond);
 
-        /* If stack hash doesn't match skip name tag and exit */
-        if (run->backtrace != backtrace) {
-            LOG_E("Verifier stack mismatch: (original) %" PRIx64 " != (new) %" PRIx64, backtrace,
-                run->backtrace);
-            run->backtrace = backtrace;
-            return true;
-        }
+    return true;
+}
 
-        LOG_I("Verifier for HASH: %" PRIx64 " (iteration: %d, left: %d). MATCH!", run->backtrace,
-            i + 1, _HF_VERIFIER_ITER - i - 1);
+/* Claims the next verifier iteration, waits up to 100ms for one if the queue is empty */
+static verifyJob_t* fuzz_verifierGetJob(honggfuzz_t* hfuzz, unsigned* iter) {
+    MX_SCOPED_LOCK(&hfuzz->verifier.queue_mutex);
+    if (TAILQ_EMPTY(&hfuzz->verifier.queue)) {
+        fuzz_queueWait(&hfuzz->verifier.queue_cond, &hfuzz->verifier.queue_mutex);
     }
 
+    verifyJob_t* job = TAILQ_FIRST(&hfuzz->verifier.queue);
+    if (!job) {
+        return NULL;
+    }
+    *iter = job->iterStarted++;
+    /* All iterations handed out, the job is finished by the thread which completes the last one */
+    if (job->iterStarted == _HF_VERIFIER_ITER) {
+        TAILQ_REMOVE(&hfuzz->verifier.queue, job, pointers);
+        job->queued = false;
+    }
+    return job;
+}
+
+static void fuzz_verifierSave(honggfuzz_t* hfuzz, const verifyJob_t* job) {
+    char verFile[PATH_MAX];
+    snprintf(verFile, sizeof(verFile), "%s.verified", job->crashFileName);
+
     /* Copy file with new suffix & remove original copy */
     int fd = TEMP_FAILURE_RETRY(open(verFile, O_CREAT | O_EXCL | O_WRONLY, 0600));
     if (fd == -1 && errno == EEXIST) {
         LOG_I("It seems that '%s' already exists, skipping", verFile);
-        return false;
+        return;
     }
     if (fd == -1) {
         PLOG_E("Couldn't create '%s'", verFile);
-        return true;
+        return;
     }
     defer {
         close(fd);
     };
-    if (!files_writeToFd(fd, run->dynfile->data, run->dynfile->size)) {
+    if (!files_writeToFd(fd, job->data, job->size)) {
         LOG_E("Couldn't save verified file as '%s'", verFile);
         unlink(verFile);
-        return true;
+        return;
+    }
+
+    LOG_I("Verified crash for HASH: %" PRIx64 " and saved it as '%s'", job->backtrace, verFile);
+    ATOMIC_PRE_INC(hfuzz->cnts.verifiedCrashesCnt);
+}
+
+/* Accounts for a finished iteration, and finishes the job once all its iterations are done */
+static void fuzz_verifierPutJob(honggfuzz_t* hfuzz, verifyJob_t* job, bool match) {
+    bool finished = false;
+    {
+        MX_SCOPED_LOCK(&hfuzz->verifier.queue_mutex);
+        job->iterDone++;
+        /* Stop early on the first mismatch, iterations already running are just waited for */
+        if (!match && !job->mismatch) {
+            job->mismatch = true;
+            if (job->queued) {
+                TAILQ_REMOVE(&hfuzz->verifier.queue, job, pointers);
+                job->queued = false;
+            }
+        }
+        finished = (!job->queued && job->iterDone == job->iterStarted);
+    }
+    if (!finished) {
+        return;
     }
 
-    LOG_I("Verified crash for HASH: %" PRIx64 " and saved it as '%s'", backtrace, verFile);
-    ATOMIC_PRE_INC(run->global->cnts.verifiedCrashesCnt);
+    if (!job->mismatch) {
+        fuzz_verifierSave(hfuzz, job);
+    }
+    free(job->data);
+    free(job);
+}
+
+/*
+ * Inputs can be prepared ahead of time only if they don't depend on the outcome of the current run,
+ * i.e. they're created by internal mutators in the main fuzzing phase
+ */
+static bool fuzz_canPrepareAhead(run_t* run) {
+    if (!run->dynfileNext || !run->mainWorker || run->isSanitizerBuild) {
+        return false;
+    }
+    if (fuzz_getState(run->global) != _HF_STATE_DYNAMIC_MAIN) {
+        return false;
+    }
+    if (run->global->exe.externalCommand || run->global->exe.postExternalCommand ||
+        run->global->exe.feedbackMutateCommand) {
+        return false;
+    }
+    return true;
+}
+
+/* Called while the fuzzed process is busy with the current input */
+void fuzz_prepareNextInput(run_t* run) {
+    if (run->dynfileNextReady || !fuzz_canPrepareAhead(run)) {
+        return;
+    }
+
+    run->dynfileNextCorpusCnt = ATOMIC_GET(run->global->io.dynfileqCnt);
+
+    dynfile_t* current = run->dynfile;
+    run->dynfile = run->dynfileNext;
+    run->dynfileNextReady = input_prepareDynamicInput(run, true);
+    run->dynfile = current;
+}
+
+static bool fuzz_fetchNextInput(run_t* run) {
+    if (!run->dynfileNextReady) {
+        return false;
+    }
+    run->dynfileNextReady = false;
+
+    if (!fuzz_canPrepareAhead(run)) {
+        return false;
+    }
+    /* The corpus has changed since, so the speculatively prepared input might be stale */
+    if (ATOMIC_GET(run->global->io.dynfileqCnt) != run->dynfileNextCorpusCnt) {
+        return false;
+    }
+
+    dynfile_t* tmp = run->dynfile;
+    run->dynfile = run->dynfileNext;
+    run->dynfileNext = tmp;
+    run->dynfileNo ^= 1U;
 
     return true;
 }
 
 static bool fuzz_fetchInput(run_t* run) {
+    if (fuzz_fetchNextInput(run)) {
+        return true;
+    }
+
     {
         fuzzState_t st = fuzz_getState(run->global);
         if (st == _HF_STATE_DYNAMIC_DRY_RUN) {
@@ -318,6 +476,10 @@ static bool fuzz_fetchInput(run_t* run) {
             if (input_prepareStaticFile(run, /* rewind= */ false, true)) {
                 return true;
             }
+            /* Every file has been run once, there's no fuzzing phase in the replay mode */
+            if (run->global->replay.enabled) {
+                return false;
+            }
             fuzz_setDynamicMainState(run);
             run->mutationsPerRun = run->global->mutate.mutationsPerRun;
         }
@@ -377,7 +539,7 @@ static bool fuzz_fetchInput(run_t* run) {
     return true;
 }
 
-static void fuzz_fuzzLoop(run_t* run) {
+static void fuzz_runReset(run_t* run) {
     run->timeStartedMillis = util_timeNowMillis();
     run->crashFileName[0] = '\0';
     run->pc = 0;
@@ -388,32 +550,87 @@ static void fuzz_fuzzLoop(run_t* run) {
     run->mainWorker = true;
     run->mutationsPerRun = run->global->mutate.mutationsPerRun;
     run->tmOutSignaled = false;
+    run->crashed = false;
+    run->dynfile->customMutate = false;
+    run->dynfile->childMangle = false;
 
     run->linux.hwCnts.cpuInstrCnt = 0;
     run->linux.hwCnts.cpuBranchCnt = 0;
     run->linux.hwCnts.bbCnt = 0;
     run->linux.hwCnts.newBBCnt = 0;
 
+    if (run->global->mutate.fixupFields) {
+        ATOMIC_CLEAR(run->global->feedback.covFeedbackMap->cmpEq[run->fuzzNo].cnt);
+    }
+    if (run->global->mutate.spliceAligned) {
+        memset(run->global->feedback.covFeedbackMap->covSig[run->fuzzNo], '\0',
+            sizeof(run->global->feedback.covFeedbackMap->covSig[run->fuzzNo]));
+    }
+}
+
+/* Returns false if there are no more inputs to be tested by this run */
+static bool fuzz_runPrepare(run_t* run) {
+    fuzz_runReset(run);
     if (!fuzz_fetchInput(run)) {
         if (run->global->cfg.minimize && fuzz_getState(run->global) == _HF_STATE_DYNAMIC_MINIMIZE) {
             fuzz_setTerminating();
-            return;
+            return false;
+        }
+        /* Other threads might be still running their last inputs, so don't terminate yet */
+        if (run->global->replay.enabled) {
+            return false;
         }
         LOG_F("Cound't prepare input for fuzzing");
     }
-    if (!subproc_Run(run)) {
-        LOG_F("Couldn't run fuzzed command");
-    }
+    return true;
+}
+
+static void fuzz_replayRecord(run_t* run) {
+    MX_SCOPED_LOCK(&run->global->replay.results_mutex);
+
+    honggfuzz_t* hfuzz = run->global;
+    hfuzz->replay.results = (replayResult_t*)util_Realloc(
+        hfuzz->replay.results, (hfuzz->replay.resultsCnt + 1) * sizeof(replayResult_t));
+    hfuzz->replay.results[hfuzz->replay.resultsCnt++] = (replayResult_t){
+        .name = util_StrDup(run->dynfile->path),
+        .size = run->dynfile->size,
+        .timeMillis = util_timeNowMillis() - run->timeExecStartedMillis,
+        .crashed = run->crashed,
+        .tmOut = run->tmOutSignaled,
+    };
+}
 
+static void fuzz_runFinish(run_t* run) {
     if (run->global->feedback.dynFileMethod != _HF_DYNFILE_NONE) {
         fuzz_perfFeedback(run);
     }
-    if (run->global->cfg.useVerifier && !fuzz_runVerifier(run)) {
+    if (run->global->replay.enabled) {
+        fuzz_replayRecord(run);
+    }
+    /* The main binary crashed, let the sanitizer build confirm it */
+    if (run->global->sanitizer.argc && run->backtrace) {
+        fuzz_sanitizerEnqueue(run, /* crashed= */ true);
+        return;
+    }
+    if (run->global->cfg.useVerifier && !fuzz_verifierEnqueue(run)) {
         return;
     }
     report_saveReport(run);
 }
 
+/* Returns false if there are no more inputs to be tested by this thread */
+static bool fuzz_fuzzLoop(run_t* run) {
+    if (!fuzz_runPrepare(run)) {
+        return false;
+    }
+    input_dedupAdd(run);
+    if (!subproc_Run(run)) {
+        LOG_F("Couldn't run fuzzed command");
+    }
+    fuzz_runFinish(run);
+    return true;
+}
+
 static void fuzz_fuzzLoopSocket(run_t* run) {
     run->timeStartedMillis = util_timeNowMillis();
     run->crashFileName[0] = '\0';
@@ -425,6 +642,7 @@ static void fuzz_fuzzLoopSocket(run_t* run) {
     run->mainWorker = true;
     run->mutationsPerRun = run->global->mutate.mutationsPerRun;
     run->tmOutSignaled = false;
+    run->crashed = false;
 
     run->linux.hwCnts.cpuInstrCnt = 0;
     run->linux.hwCnts.cpuBranchCnt = 0;
@@ -461,82 +679,315 @@ static void fuzz_fuzzLoopSocket(run_t* run) {
     if (run->global->feedback.dynFileMethod != _HF_DYNFILE_NONE) {
         fuzz_perfFeedback(run);
     }
-    if (run->global->cfg.useVerifier && !fuzz_runVerifier(run)) {
-        return;
-    }
-
     report_saveReport(run);
 }
 
-static void* fuzz_threadNew(void* arg) {
-    honggfuzz_t* hfuzz = (honggfuzz_t*)arg;
-    unsigned int fuzzNo = ATOMIC_POST_INC(hfuzz->threads.threadsActiveCnt);
-    LOG_I("Launched new fuzzing thread, no. #%" PRId32, fuzzNo);
-
-    run_t run = {
+static void fuzz_runInit(honggfuzz_t* hfuzz, run_t* run, uint32_t fuzzNo) {
+    *run = (run_t){
         .global = hfuzz,
         .pid = 0,
         .dynfile = (dynfile_t*)util_Malloc(sizeof(dynfile_t) + hfuzz->io.maxFileSz),
+        .dynfileNext = NULL,
+        .dynfileNextReady = false,
+        .dynfileNo = 0,
+        .spliceCurrent = NULL,
         .fuzzNo = fuzzNo,
         .persistentSock = -1,
+        .sparesCnt = 0,
         .tmOutSignaled = false,
+        .dedupBloom = (uint64_t*)util_Calloc(_HF_DEDUP_BLOOM_BITS / 8),
+        .dedupBloomCnt = 0,
     };
 
     /* Do not try to handle input files with socketfuzzer */
     if (!hfuzz->socketFuzzer.enabled) {
-        if (!(run.dynfile->data = files_mapSharedMem(hfuzz->mutate.maxInputSz, &(run.dynfile->fd),
+        if (!(run->dynfile->data = files_mapSharedMem(hfuzz->mutate.maxInputSz, &(run->dynfile->fd),
                   "hf-input", /* nocore= */ true, /* export= */ false))) {
             LOG_F("Couldn't create an input file of size: %zu", hfuzz->mutate.maxInputSz);
         }
-    }
-    defer {
-        if (run.dynfile->fd != -1) {
-            close(run.dynfile->fd);
+        /* The second input buffer, filled in while the fuzzed process runs the first one */
+        run->dynfileNext = (dynfile_t*)util_Malloc(sizeof(dynfile_t));
+        run->dynfileNext->size = hfuzz->mutate.maxInputSz;
+        if (!(run->dynfileNext->data =
+                    files_mapSharedMem(hfuzz->mutate.maxInputSz, &(run->dynfileNext->fd),
+                        "hf-input-alt", /* nocore= */ true, /* export= */ false))) {
+            LOG_F("Couldn't create an input file of size: %zu", hfuzz->mutate.maxInputSz);
         }
-    };
+    }
 
-    if (!arch_archThreadInit(&run)) {
+    if (!arch_archThreadInit(run)) {
         LOG_F("Could not initialize the thread");
     }
+}
 
+static void fuzz_runDestroy(run_t* run) {
+    if (run->pid) {
+        subproc_kill(run, SIGKILL);
+    }
+    subproc_destroySpares(run);
+    if (run->dynfile->fd != -1) {
+        close(run->dynfile->fd);
+    }
+    if (run->dynfileNext && run->dynfileNext->fd != -1) {
+        close(run->dynfileNext->fd);
+    }
+    free(run->dedupBloom);
+    arch_archThreadDestroy(run);
+}
+
+/* Accounts for a new iteration, returns false if the iterations limit has been reached */
+static bool fuzz_nextIteration(run_t* run) {
+    /* Check if dry run mode with verifier enabled */
+    if (run->global->mutate.mutationsPerRun == 0U && run->global->cfg.useVerifier &&
+        !run->global->socketFuzzer.enabled) {
+        if (ATOMIC_POST_INC(run->global->cnts.mutationsCnt) >= run->global->io.fileCnt) {
+            return false;
+        }
+    }
+    /* Check for max iterations limit if set */
+    else if ((ATOMIC_POST_INC(run->global->cnts.mutationsCnt) >=
+                 run->global->mutate.mutationsMax) &&
+             run->global->mutate.mutationsMax) {
+        return false;
+    }
+    return true;
+}
+
+static bool fuzz_shouldStop(run_t* run) {
+    if (fuzz_isTerminating()) {
+        return true;
+    }
+    if (run->global->cfg.exitUponCrash && ATOMIC_GET(run->global->cnts.crashesCnt) > 0) {
+        LOG_I("Seen a crash. Terminating all fuzzing threads");
+        fuzz_setTerminating();
+        return true;
+    }
+    return false;
+}
+
+static void fuzz_threadLoop(run_t* run) {
+    for (;;) {
+        if (!fuzz_nextIteration(run)) {
+            break;
+        }
+
+        if (run->global->socketFuzzer.enabled) {
+            fuzz_fuzzLoopSocket(run);
+        } else if (!fuzz_fuzzLoop(run)) {
+            break;
+        }
+
+        if (fuzz_shouldStop(run)) {
+            break;
+        }
+    }
+}
+
+/*
+ * A single thread drives many fuzzed processes: every idle process gets a new input, and then
+ * the thread waits (in arch_reapChildren) for any of the running ones to finish its round
+ */
+static void fuzz_threadLoopMux(run_t* runs, size_t cnt) {
+#if !defined(_HF_ARCH_LINUX)
+    LOG_F("Running multiple processes per fuzzing thread is supported under Linux only");
+#else
+    bool* running = (bool*)util_Calloc(cnt * sizeof(bool));
+    bool* done = (bool*)util_Calloc(cnt * sizeof(bool));
+    defer {
+        free(running);
+        free(done);
+    };
+
+    bool stop = false;
     for (;;) {
-        /* Check if dry run mode with verifier enabled */
-        if (run.global->mutate.mutationsPerRun == 0U && run.global->cfg.useVerifier &&
-            !hfuzz->socketFuzzer.enabled) {
-            if (ATOMIC_POST_INC(run.global->cnts.mutationsCnt) >= run.global->io.fileCnt) {
+        for (size_t i = 0; i < cnt && !stop; i++) {
+            if (running[i]) {
+                continue;
+            }
+            if (!fuzz_nextIteration(&runs[i]) || !fuzz_runPrepare(&runs[i])) {
+                stop = true;
                 break;
             }
+            if (!subproc_Start(&runs[i])) {
+                LOG_F("Couldn't run fuzzed command");
+            }
+            running[i] = true;
         }
-        /* Check for max iterations limit if set */
-        else if ((ATOMIC_POST_INC(run.global->cnts.mutationsCnt) >=
-                     run.global->mutate.mutationsMax) &&
-                 run.global->mutate.mutationsMax) {
-            break;
+
+        size_t runningCnt = 0;
+        for (size_t i = 0; i < cnt; i++) {
+            runningCnt += running[i] ? 1 : 0;
         }
+        if (runningCnt == 0) {
+            return;
+        }
+
+        arch_reapChildren(runs, running, done, cnt);
 
-        if (hfuzz->socketFuzzer.enabled) {
-            fuzz_fuzzLoopSocket(&run);
-        } else {
-            fuzz_fuzzLoop(&run);
+        for (size_t i = 0; i < cnt; i++) {
+            if (!done[i]) {
+                continue;
+            }
+            done[i] = false;
+            running[i] = false;
+            subproc_Finish(&runs[i]);
+            fuzz_runFinish(&runs[i]);
+            if (fuzz_shouldStop(&runs[i])) {
+                stop = true;
+            }
         }
+    }
+#endif /* !defined(_HF_ARCH_LINUX) */
+}
 
-        if (fuzz_isTerminating()) {
-            break;
+static bool fuzz_verifierRunOnce(run_t* run, const verifyJob_t* job, unsigned iter) {
+    LOG_I("Launching verifier for HASH: %" PRIx64 " (iteration: %u out of %d)", job->backtrace,
+        iter + 1, _HF_VERIFIER_ITER);
+
+    fuzz_runReset(run);
+    run->mainWorker = false;
+    /* Not input_setSize(), as mutate.maxInputSz might have been lowered since it was queued */
+#if !defined(__CYGWIN__) && !defined(_HF_ARCH_DARWIN)
+    if (TEMP_FAILURE_RETRY(ftruncate(run->dynfile->fd, job->size)) == -1) {
+        PLOG_W("ftruncate(run->dynfile->fd=%d, sz=%zu)", run->dynfile->fd, job->size);
+    }
+#endif /* !defined(__CYGWIN__) && !defined(_HF_ARCH_DARWIN) */
+    run->dynfile->size = job->size;
+    memcpy(run->dynfile->data, job->data, job->size);
+
+    if (!subproc_Run(run)) {
+        LOG_F("subproc_Run()");
+    }
+
+    /* If stack hash doesn't match skip name tag and exit */
+    if (run->backtrace != job->backtrace) {
+        LOG_E("Verifier stack mismatch: (original) %" PRIx64 " != (new) %" PRIx64,
+            job->backtrace, run->backtrace);
+        return false;
+    }
+
+    LOG_I("Verifier for HASH: %" PRIx64 " (iteration: %u). MATCH!", job->backtrace, iter + 1);
+    return true;
+}
+
+/*
+ * Verifier threads run iterations of the queued crashes concurrently, each with its own (possibly
+ * persistent) fuzzed process. They finish once the fuzzing threads are done and the queue is empty
+ */
+static void* fuzz_verifierThread(void* arg) {
+    honggfuzz_t* hfuzz = (honggfuzz_t*)arg;
+    uint32_t verifierNo = ATOMIC_POST_INC(hfuzz->verifier.threadsActiveCnt);
+
+    run_t run;
+    fuzz_runInit(
+        hfuzz, &run, hfuzz->threads.threadsMax * hfuzz->threads.childrenPerThread + verifierNo);
+    run.isVerifier = true;
+    defer {
+        fuzz_runDestroy(&run);
+    };
+
+    for (;;) {
+        unsigned iter;
+        verifyJob_t* job = fuzz_verifierGetJob(hfuzz, &iter);
+        if (!job) {
+            if (ATOMIC_GET(hfuzz->threads.threadsFinished) >= hfuzz->threads.threadsMax) {
+                break;
+            }
+            continue;
         }
+        bool match = fuzz_verifierRunOnce(&run, job, iter);
+        fuzz_verifierPutJob(hfuzz, job, match);
+    }
 
-        if (run.global->cfg.exitUponCrash && ATOMIC_GET(run.global->cnts.crashesCnt) > 0) {
-            LOG_I("Seen a crash. Terminating all fuzzing threads");
-            fuzz_setTerminating();
-            break;
+    return NULL;
+}
+
+static void fuzz_sanitizerConfirm(run_t* run, const sanInput_t* in) {
+    fuzz_runReset(run);
+
+    /* Not input_setSize(), as mutate.maxInputSz might have been lowered since it was queued */
+#if !defined(__CYGWIN__) && !defined(_HF_ARCH_DARWIN)
+    if (TEMP_FAILURE_RETRY(ftruncate(run->dynfile->fd, in->size)) == -1) {
+        PLOG_W("ftruncate(run->dynfile->fd=%d, sz=%zu)", run->dynfile->fd, in->size);
+    }
+#endif /* !defined(__CYGWIN__) && !defined(_HF_ARCH_DARWIN) */
+    run->dynfile->size = in->size;
+    memcpy(run->dynfile->data, in->data, in->size);
+
+    if (!subproc_Run(run)) {
+        LOG_F("Couldn't run the sanitizer build");
+    }
+
+    if (run->crashFileName[0]) {
+        report_saveReport(run);
+    } else if (in->crashed && !run->backtrace) {
+        ATOMIC_POST_INC(run->global->cnts.sanUnconfirmedCnt);
+        LOG_I("Crash of the main binary (input size: %zu) not reproduced by the sanitizer build",
+            in->size);
+    }
+}
+
+/*
+ * Re-runs inputs queued by the fuzzing threads with the sanitizer build. It finishes once the
+ * fuzzing threads are done and the queue is empty; when terminating, only crashes are confirmed
+ */
+static void* fuzz_sanitizerThread(void* arg) {
+    honggfuzz_t* hfuzz = (honggfuzz_t*)arg;
+    LOG_I("Launched the sanitizer build thread: '%s'", hfuzz->sanitizer.cmdline[0]);
+
+    /* Past the fuzzing threads' numbers, the sanitizer build gets no feedback slot anyway */
+    run_t run;
+    fuzz_runInit(hfuzz, &run, hfuzz->threads.threadsMax * hfuzz->threads.childrenPerThread);
+    run.isSanitizerBuild = true;
+    snprintf(run.dynfile->path, sizeof(run.dynfile->path), "[SANITIZER]");
+    defer {
+        fuzz_runDestroy(&run);
+    };
+
+    for (;;) {
+        sanInput_t* in = fuzz_sanitizerDequeue(hfuzz);
+        if (!in) {
+            if (ATOMIC_GET(hfuzz->threads.threadsFinished) >= hfuzz->threads.threadsMax) {
+                break;
+            }
+            continue;
+        }
+        if (in->crashed || !fuzz_isTerminating()) {
+            fuzz_sanitizerConfirm(&run, in);
         }
+        free(in->data);
+        free(in);
+    }
+
+    LOG_I("Terminating the sanitizer build thread");
+    return NULL;
+}
+
+static void* fuzz_threadNew(void* arg) {
+    honggfuzz_t* hfuzz = (honggfuzz_t*)arg;
+    unsigned int threadNo = ATOMIC_POST_INC(hfuzz->threads.threadsActiveCnt);
+    LOG_I("Launched new fuzzing thread, no. #%" PRId32, threadNo);
+
+    size_t runsCnt = hfuzz->threads.childrenPerThread;
+    run_t* runs = (run_t*)util_Malloc(runsCnt * sizeof(run_t));
+    for (size_t i = 0; i < runsCnt; i++) {
+        fuzz_runInit(hfuzz, &runs[i], threadNo * runsCnt + i);
     }
+    defer {
+        for (size_t i = 0; i < runsCnt; i++) {
+            fuzz_runDestroy(&runs[i]);
+        }
+        free(runs);
+    };
 
-    if (run.pid) {
-        kill(run.pid, SIGKILL);
+    if (runsCnt > 1) {
+        fuzz_threadLoopMux(runs, runsCnt);
+    } else {
+        fuzz_threadLoop(&runs[0]);
     }
 
-    size_t j = ATOMIC_PRE_INC(run.global->threads.threadsFinished);
-    LOG_I("Terminating thread no. #%" PRId32 ", left: %zu", fuzzNo, hfuzz->threads.threadsMax - j);
+    size_t j = ATOMIC_PRE_INC(hfuzz->threads.threadsFinished);
+    LOG_I("Terminating thread no. #%" PRId32 ", left: %zu", threadNo, hfuzz->threads.threadsMax - j);
     return NULL;
 }
 
@@ -552,6 +1003,10 @@ void fuzz_threadsStart(honggfuzz_t* hfuzz) {
         /* Don't do dry run with socketFuzzer */
         LOG_I("Entering phase - Feedback Driven Mode (SocketFuzzer)");
         hfuzz->feedback.state = _HF_STATE_DYNAMIC_MAIN;
+    } else if (hfuzz->replay.enabled) {
+        /* Each input is run once (at its full size), the same way as during the dry run */
+        LOG_I("Entering phase: Replay");
+        hfuzz->feedback.state = _HF_STATE_DYNAMIC_DRY_RUN;
     } else if (hfuzz->feedback.dynFileMethod != _HF_DYNFILE_NONE) {
         LOG_I("Entering phase 1/3: Dry Run");
         hfuzz->feedback.state = _HF_STATE_DYNAMIC_DRY_RUN;
@@ -566,4 +1021,27 @@ void fuzz_threadsStart(honggfuzz_t* hfuzz) {
             PLOG_F("Couldn't run a thread #%zu", i);
         }
     }
+    if (hfuzz->sanitizer.argc && !subproc_runThread(hfuzz, &hfuzz->sanitizer.thread,
+                                     fuzz_sanitizerThread, /* joinable= */ true)) {
+        PLOG_F("Couldn't run the sanitizer build thread");
+    }
+    for (size_t i = 0; hfuzz->cfg.useVerifier && i < _HF_VERIFIER_THREADS; i++) {
+        if (!subproc_runThread(hfuzz, &hfuzz->verifier.threads[i], fuzz_verifierThread,
+                /* joinable= */ true)) {
+            PLOG_F("Couldn't run a verifier thread #%zu", i);
+        }
+    }
+}
+
+/*
+ * Lets the sanitizer build and the verifier threads finish with crashes found by the (already
+ * finished) fuzzing threads
+ */
+void fuzz_threadsWait(honggfuzz_t* hfuzz) {
+    if (hfuzz->sanitizer.argc) {
+        pthread_join(hfuzz->sanitizer.thread, NULL);
+    }
+    for (size_t i = 0; hfuzz->cfg.useVerifier && i < _HF_VERIFIER_THREADS; i++) {
+        pthread_join(hfuzz->verifier.threads[i], NULL);
+    }
 }
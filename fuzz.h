@@ -29,9 +29,11 @@
 #include "honggfuzz.h"
 
 extern void fuzz_threadsStart(honggfuzz_t* fuzz);
+extern void fuzz_threadsWait(honggfuzz_t* hfuzz);
 extern bool fuzz_isTerminating(void);
 extern void fuzz_setTerminating(void);
 extern bool fuzz_shouldTerminate(void);
 extern fuzzState_t fuzz_getState(honggfuzz_t* hfuzz);
+extern void fuzz_prepareNextInput(run_t* run);
 
 #endif
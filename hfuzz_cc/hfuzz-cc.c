@@ -1,5 +1,6 @@
 #include <errno.h>
 #include <fcntl.h>
+#include <fnmatch.h>
 #include <inttypes.h>
 #include <libgen.h>
 #include <limits.h>
@@ -93,6 +94,123 @@ static bool useClangFuzzerNoLink() {
     return false;
 }
 
+/*
+ * The 'fast' profile keeps inlining and builtins, so the target runs at close to its production
+ * speed. Comparisons are still visible through the sancov hooks and the --wrap'd functions
+ */
+static bool useFastProfile() {
+    if (getenv("HFUZZ_CC_FAST")) {
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Function entry/exit hooks maintain a hash of the call stack, which makes edge coverage calling
+ * context sensitive (with --context_cov)
+ */
+static bool useContextProfile() {
+    if (getenv("HFUZZ_CC_CONTEXT")) {
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Allow/deny lists use the clang's sanitizer special case list format ('src:glob', 'fun:glob'). They
+ * are passed to clang, and 'src:' entries are also checked here, so translation units which are
+ * not instrumented at all are compiled without any of the coverage-related flags (with gcc too)
+ */
+static const char* getAllowList() {
+    return getenv("HFUZZ_CC_ALLOWLIST");
+}
+
+static const char* getDenyList() {
+    return getenv("HFUZZ_CC_DENYLIST");
+}
+
+static bool isSourceFile(const char* arg) {
+    static const char* const exts[] = {
+        ".c", ".cc", ".cp", ".cpp", ".cxx", ".c++", ".C", ".CC", ".CPP", ".m", ".mm"};
+    const char* ext = strrchr(arg, '.');
+    if (arg[0] == '-' || ext == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < ARRAYSIZE(exts); i++) {
+        if (strcmp(ext, exts[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Returns true if 'src' matches any of the 'src:' entries of the list, sets hasSrc if it has any */
+static bool listMatchesSrc(const char* listFile, const char* src, bool* hasSrc) {
+    FILE* f = fopen(listFile, "rb");
+    if (f == NULL) {
+        PLOG_F("Couldn't open the coverage allow/deny list '%s'", listFile);
+    }
+    defer {
+        fclose(f);
+    };
+
+    char rpath[PATH_MAX];
+    if (realpath(src, rpath) == NULL) {
+        snprintf(rpath, sizeof(rpath), "%s", src);
+    }
+
+    char* lineptr = NULL;
+    size_t n = 0;
+    defer {
+        free(lineptr);
+    };
+    while (getline(&lineptr, &n, f) > 0) {
+        if (!util_strStartsWith(lineptr, "src:")) {
+            continue;
+        }
+        char* glob = &lineptr[strlen("src:")];
+        /* Strip the category ('=...') and the trailing whitespace */
+        glob[strcspn(glob, "=\r\n")] = '\0';
+        for (size_t len = strlen(glob); len > 0 && (glob[len - 1] == ' ' || glob[len - 1] == '\t');
+             len--) {
+            glob[len - 1] = '\0';
+        }
+        *hasSrc = true;
+        if (fnmatch(glob, src, 0) == 0 || fnmatch(glob, rpath, 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Instrument, unless all source files given to the compiler are excluded by the allow/deny lists */
+static bool shouldInstrument(int argc, char** argv) {
+    const char* allowList = getAllowList();
+    const char* denyList = getDenyList();
+    if (allowList == NULL && denyList == NULL) {
+        return true;
+    }
+
+    bool hasSources = false;
+    for (int i = 1; i < argc; i++) {
+        if (!isSourceFile(argv[i])) {
+            continue;
+        }
+        hasSources = true;
+
+        bool hasSrc = false;
+        if (denyList && listMatchesSrc(denyList, argv[i], &hasSrc)) {
+            continue;
+        }
+        hasSrc = false;
+        if (allowList && !listMatchesSrc(allowList, argv[i], &hasSrc) && hasSrc) {
+            continue;
+        }
+        return true;
+    }
+    return !hasSources;
+}
+
 static bool isLDMode(int argc, char** argv) {
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--version") == 0) {
@@ -307,19 +425,37 @@ static char* getLibHFCommonPath() {
     return path;
 }
 
-static void commonPreOpts(int* j, char** args) {
+static void commonPreOpts(int* j, char** args, bool instrument) {
     args[(*j)++] = getIncPaths();
 
     if (!isGCC) {
         args[(*j)++] = "-Wno-unused-command-line-argument";
     }
 
-    /*
-     * Make the execution flow more explicit, allowing for more code blocks
-     * (and better code coverage estimates)
-     */
-    args[(*j)++] = "-fno-inline";
-    args[(*j)++] = "-fno-builtin";
+    if (!instrument) {
+        /* Compiled as it is, so uninteresting code runs at its native speed */
+    } else if (useFastProfile()) {
+        /*
+         * Only keep calls to comparison functions, so they are not expanded into inline code,
+         * which --wrap (and libhfuzz) cannot see
+         */
+        args[(*j)++] = "-fno-builtin-memcmp";
+        args[(*j)++] = "-fno-builtin-bcmp";
+        args[(*j)++] = "-fno-builtin-strcmp";
+        args[(*j)++] = "-fno-builtin-strncmp";
+        args[(*j)++] = "-fno-builtin-strcasecmp";
+        args[(*j)++] = "-fno-builtin-strncasecmp";
+        args[(*j)++] = "-fno-builtin-strstr";
+        args[(*j)++] = "-fno-builtin-strcasestr";
+        args[(*j)++] = "-fno-builtin-memmem";
+    } else {
+        /*
+         * Make the execution flow more explicit, allowing for more code blocks
+         * (and better code coverage estimates)
+         */
+        args[(*j)++] = "-fno-inline";
+        args[(*j)++] = "-fno-builtin";
+    }
     args[(*j)++] = "-fno-omit-frame-pointer";
     args[(*j)++] = "-D__NO_STRING_INLINES";
 
@@ -340,7 +476,10 @@ static void commonPreOpts(int* j, char** args) {
     }
 }
 
-static void commonPostOpts(int* j, char** args, int argc, char** argv) {
+static void commonPostOpts(int* j, char** args, int argc, char** argv, bool instrument) {
+    if (!instrument) {
+        return;
+    }
     if (isGCC) {
         if (useBelowGCC8()) {
             /* trace-pc is the best that gcc-6/7 currently offers */
@@ -349,6 +488,9 @@ static void commonPostOpts(int* j, char** args, int argc, char** argv) {
             /* gcc-8+ offers trace-cmp as well, but it's not that widely used yet */
             args[(*j)++] = "-fsanitize-coverage=trace-pc,trace-cmp";
         }
+        if (useContextProfile()) {
+            args[(*j)++] = "-finstrument-functions";
+        }
     } else {
         if (useClangFuzzerNoLink()) {
             args[(*j)++] = "-fno-sanitize-coverage=trace-pc-guard";
@@ -360,7 +502,25 @@ static void commonPostOpts(int* j, char** args, int argc, char** argv) {
                 args[(*j)++] = "-fno-sanitize=fuzzer";
                 args[(*j)++] = "-fno-sanitize=fuzzer-no-link";
             }
-            args[(*j)++] = "-fsanitize-coverage=trace-pc-guard,trace-cmp,trace-div,indirect-calls";
+            args[(*j)++] = "-fsanitize-coverage=trace-pc-guard,trace-cmp,trace-div,indirect-calls,"
+                           "stack-depth";
+        }
+        if (useContextProfile()) {
+            /* Hooks are added after inlining, so inlined calls don't count as separate contexts */
+            args[(*j)++] = "-finstrument-functions-after-inlining";
+        }
+
+        static char allowListArg[PATH_MAX + 64];
+        static char denyListArg[PATH_MAX + 64];
+        if (getAllowList()) {
+            snprintf(allowListArg, sizeof(allowListArg), "-fsanitize-coverage-allowlist=%s",
+                getAllowList());
+            args[(*j)++] = allowListArg;
+        }
+        if (getDenyList()) {
+            snprintf(denyListArg, sizeof(denyListArg), "-fsanitize-coverage-ignorelist=%s",
+                getDenyList());
+            args[(*j)++] = denyListArg;
         }
     }
 }
@@ -375,13 +535,14 @@ static int ccMode(int argc, char** argv) {
         args[j++] = "cc";
     }
 
-    commonPreOpts(&j, args);
+    bool instrument = shouldInstrument(argc, argv);
+    commonPreOpts(&j, args, instrument);
 
     for (int i = 1; i < argc; i++) {
         args[j++] = argv[i];
     }
 
-    commonPostOpts(&j, args, argc, argv);
+    commonPostOpts(&j, args, argc, argv, instrument);
 
     return execCC(j, args);
 }
@@ -396,7 +557,8 @@ static int ldMode(int argc, char** argv) {
         args[j++] = "cc";
     }
 
-    commonPreOpts(&j, args);
+    bool instrument = shouldInstrument(argc, argv);
+    commonPreOpts(&j, args, instrument);
 
 /* MacOS X linker doesn't like those */
 #ifndef _HF_ARCH_DARWIN
@@ -481,7 +643,7 @@ static int ldMode(int argc, char** argv) {
     args[j++] = "-latomic";
 #endif
 
-    commonPostOpts(&j, args, argc, argv);
+    commonPostOpts(&j, args, argc, argv, instrument);
 
     return execCC(j, args);
 }
@@ -43,8 +43,12 @@
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
 #include "libhfcommon/util.h"
+#include "report.h"
 #include "socketfuzzer.h"
 #include "subproc.h"
+#if defined(_HF_ARCH_LINUX)
+#include "linux/cgroup.h"
+#endif /* defined(_HF_ARCH_LINUX) */
 
 static int sigReceived = 0;
 static bool clearWin = false;
@@ -206,13 +210,13 @@ static void printSummary(honggfuzz_t* hfuzz) {
     usage.ru_maxrss >>= 10;
 #endif
     LOG_I("Summary iterations:%zu time:%" PRIu64 " speed:%" PRIu64 " "
-          "crashes_count:%zu timeout_count:%zu new_units_added:%zu "
+          "crashes_count:%zu timeout_count:%zu dup_skipped_count:%zu new_units_added:%zu "
           "slowest_unit_ms:%" PRId64 " guard_nb:%" PRIu64 " branch_coverage_percent:%" PRIu64 " "
-          "peak_rss_mb:%lu",
+          "peak_rss_mb:%lu recycled_count:%zu",
         hfuzz->cnts.mutationsCnt, elapsed_sec, exec_per_sec, hfuzz->cnts.crashesCnt,
-        hfuzz->cnts.timeoutedCnt, hfuzz->io.newUnitsAdded,
+        hfuzz->cnts.timeoutedCnt, hfuzz->cnts.dupSkippedCnt, hfuzz->io.newUnitsAdded,
         hfuzz->timing.timeOfLongestUnitInMilliseconds, hfuzz->feedback.covFeedbackMap->guardNb,
-        branch_percent_cov, usage.ru_maxrss);
+        branch_percent_cov, usage.ru_maxrss, hfuzz->cnts.recycledCnt);
 }
 
 static void pingThreads(honggfuzz_t* hfuzz) {
@@ -388,6 +392,9 @@ int main(int argc, char** argv) {
         LOG_F("files_mapSharedMem(name='hf-covfeddback', sz=%zu, dir='%s') failed",
             sizeof(feedback_t), hfuzz.io.workDir);
     }
+    hfuzz.feedback.covFeedbackMap->cmpEqLog = hfuzz.mutate.fixupFields;
+    hfuzz.feedback.covFeedbackMap->covSigLog = hfuzz.mutate.spliceAligned;
+    hfuzz.feedback.covFeedbackMap->ctxCovLog = hfuzz.feedback.ctxCov;
     if (hfuzz.feedback.cmpFeedback) {
         if (!(hfuzz.feedback.cmpFeedbackMap = files_mapSharedMem(sizeof(cmpfeedback_t),
                   &hfuzz.feedback.cmpFeedbackFd, "hf-cmpfeedback", /* nocore= */ true,
@@ -396,6 +403,13 @@ int main(int argc, char** argv) {
                 sizeof(cmpfeedback_t), hfuzz.io.workDir);
         }
     }
+    if (hfuzz.mutate.childMangle) {
+        if (!(hfuzz.mutate.corpusMap = files_mapSharedMem(_HF_CORPUS_MAP_SIZE,
+                  &hfuzz.mutate.corpusFd, "hf-corpus", /* nocore= */ true, /* export= */ false))) {
+            LOG_F("files_mapSharedMem(name='hf-corpus', sz=%zu) failed",
+                (size_t)_HF_CORPUS_MAP_SIZE);
+        }
+    }
 
     setupRLimits();
     setupSignalsPreThreads();
@@ -407,6 +421,7 @@ int main(int argc, char** argv) {
     }
 
     mainThreadLoop(&hfuzz);
+    fuzz_threadsWait(&hfuzz);
 
     /* Clean-up global buffers */
     if (hfuzz.feedback.blacklist) {
@@ -419,6 +434,7 @@ int main(int argc, char** argv) {
     if (hfuzz.linux.symsWl) {
         free(hfuzz.linux.symsWl);
     }
+    arch_cgroupCleanup(&hfuzz);
 #elif defined(_HF_ARCH_NETBSD)
     if (hfuzz.netbsd.symsBl) {
         free(hfuzz.netbsd.symsBl);
@@ -433,5 +449,9 @@ int main(int argc, char** argv) {
 
     printSummary(&hfuzz);
 
+    if (hfuzz.replay.enabled && !report_saveReplay(&hfuzz)) {
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
@@ -52,14 +52,54 @@
 /* Name of envvar which indicates sequential number of fuzzer */
 #define _HF_THREAD_NO_ENV "HFUZZ_THREAD_NO"
 
+/* Name of envvar which passes the maximum input size (in bytes) to the fuzzed process */
+#define _HF_INPUT_MAX_SIZE_ENV "HFUZZ_INPUT_MAX_SIZE"
+
 /* Name of envvar which indicates that the netDriver should be used */
 #define _HF_THREAD_NETDRIVER_ENV "HFUZZ_USE_NETDRIVER"
 
 /* Name of envvar which indicates honggfuzz's log level in use */
 #define _HF_LOG_LEVEL_ENV "HFUZZ_LOG_LEVEL"
 
+/* Persistent-mode targets restore their memory after each input if it's set */
+#define _HF_SNAPSHOT_ENV "HFUZZ_USE_SNAPSHOT"
+
+/* Persistent-mode targets stop inputs running longer than this many milliseconds by themselves */
+#define _HF_WATCHDOG_ENV "HFUZZ_WATCHDOG_MSEC"
+/* Extra time given to the in-process watchdog, before the process is killed instead */
+#define _HF_WATCHDOG_GRACE_MSEC 1000
+
 /* Number of crash verifier iterations before tag crash as stable */
 #define _HF_VERIFIER_ITER 5
+/* Number of verifier threads, so all iterations of a single crash can run concurrently */
+#define _HF_VERIFIER_THREADS _HF_VERIFIER_ITER
+
+/* Rounds of a new persistent process over which its per-input latency baseline is measured */
+#define _HF_RECYCLE_BASE_ROUNDS 256
+/* Growth of RSS (in KiB) in a single persistent round, above which the input is saved */
+#define _HF_RECYCLE_RSS_GROWTH_KIB 1024
+
+/* Equal operands of non-constant comparisons logged per run (--fixup_fields) */
+#define _HF_CMP_EQ_MAX 32
+/* Length and checksum fields tracked per corpus input (--fixup_fields) */
+#define _HF_FIELDS_MAX 8
+/* How far before a checksum field the start of the checksummed data is looked for */
+#define _HF_FIELDS_CRC_WINDOW 1024
+/* Bytes between a length field and the start of the data it counts (till EOF) */
+#define _HF_FIELDS_LEN_SLACK 16
+
+/* Size of the corpus-wide token table (power of 2), and the max length of a token in it */
+#define _HF_TOKENS_MAX 4096U
+#define _HF_TOKEN_MAX_LEN 32U
+
+/* Size (in 64-bit words) of the sampled coverage sketch of an input (--splice_aligned) */
+#define _HF_COV_SIG_WORDS 4
+/* Max number of splice anchors of a single corpus input */
+#define _HF_SPLICE_ANCHORS_MAX 4096U
+/* Corpus inputs compared (by coverage) when looking for a splice partner */
+#define _HF_SPLICE_CANDIDATES 4U
+/* Max bytes of the mutated input searched for anchors shared with the splice partner */
+#define _HF_SPLICE_SCAN_MAX (1024U * 64U)
 
 /* Size (in bytes) for report data to be stored in stack before written to file */
 #define _HF_REPORT_SIZE 32768
@@ -69,9 +109,27 @@
 #define _HF_PERF_BITMAP_BITSZ_MASK 0x7FFFFFFULL
 /* Maximum number of PC guards (=trace-pc-guard) we support */
 #define _HF_PC_GUARD_MAX (1024ULL * 1024ULL * 64ULL)
+/* Size (in bytes) of the bitmap of edges seen in distinct calling contexts (--context_cov) */
+#define _HF_CTX_MAP_SIZE (1024U * 512U)
+/* Max number of calling contexts (bits of the bitmap) per edge (--context_cov) */
+#define _HF_CTX_PER_EDGE 16U
+
+/* Maximum size of the input file in bytes (1 GiB) */
+#define _HF_INPUT_MAX_SIZE (1024ULL * 1024ULL * 1024ULL)
+
+/* Size (in bits, power of 2) of the per-thread filter of recently executed inputs */
+#define _HF_DEDUP_BLOOM_BITS (1024U * 1024U)
+/* Number of attempts at re-mutating an input which was recently executed */
+#define _HF_DEDUP_MAX_REROLLS 4
 
-/* Maximum size of the input file in bytes (1 MiB) */
-#define _HF_INPUT_MAX_SIZE (1024ULL * 1024ULL)
+/* Max number of pre-forked processes per fuzzed process (--linux_spare_children) */
+#define _HF_SPARES_MAX 8
+
+/* Number of threads reading the input corpus into memory (with --preload_input) */
+#define _HF_PRELOAD_THREADS 32
+
+/* Maximum number of inputs waiting to be re-run with the sanitizer build (--sanitizer_cmdline) */
+#define _HF_SANITIZER_QUEUE_MAX 1024
 
 /* Default maximum size of produced inputs */
 #define _HF_INPUT_DEFAULT_SIZE (1024ULL * 8)
@@ -80,6 +138,10 @@
 #define _HF_CMP_BITMAP_FD 1019
 /* FD used to log inside the child process */
 #define _HF_LOG_FD 1020
+/* FD used to share the corpus with persistent processes mutating inputs (--persistent_mangle) */
+#define _HF_CORPUS_FD 1017
+/* FD used to represent the second (double-buffered) input file in the persistent mode */
+#define _HF_INPUT_ALT_FD 1018
 /* FD used to represent the input file */
 #define _HF_INPUT_FD 1021
 /* FD used to pass coverage feedback from the fuzzed process */
@@ -94,8 +156,20 @@
 /* Maximum number of supported execve() args */
 #define _HF_ARGS_MAX 512
 
+/* Set in the persistent mode size indicator if the input is in _HF_INPUT_ALT_FD */
+#define _HF_INPUT_ALT_FLAG (1ULL << 63)
+/* Set in the persistent mode size indicator if the fuzzed process should mutate the input itself */
+#define _HF_INPUT_MUTATE_FLAG (1ULL << 62)
+/* Set in the persistent mode size indicator if the input is to be created from a corpus seed */
+#define _HF_INPUT_MANGLE_FLAG (1ULL << 61)
+
+/* Size of the corpus mapping shared with persistent processes (--persistent_mangle) */
+#define _HF_CORPUS_MAP_SIZE (1024ULL * 1024ULL * 1024ULL)
+
 /* Message indicating that the fuzzed process is ready for new data */
 static const uint8_t HFReadyTag = 'R';
+/* Sent instead of HFReadyTag, if the previous input was stopped by the in-process watchdog */
+static const uint8_t HFTimeoutTag = 'T';
 
 /* Maximum number of active fuzzing threads */
 #define _HF_THREAD_MAX 1024U
@@ -112,6 +186,7 @@ typedef enum {
     _HF_DYNFILE_BTS_EDGE = 0x10,
     _HF_DYNFILE_IPT_BLOCK = 0x20,
     _HF_DYNFILE_SOFT = 0x40,
+    _HF_DYNFILE_BP_BLOCK = 0x80,
 } dynFileMethod_t;
 
 typedef struct {
@@ -124,6 +199,12 @@ typedef struct {
     uint64_t softCntCmp;
 } hwcnt_t;
 
+/* A basic block of an uninstrumented binary, covered with a one-shot breakpoint */
+typedef struct {
+    uint64_t addr;
+    uint8_t origByte;
+} bpBlock_t;
+
 typedef struct {
     uint32_t capacity;
     uint32_t* pChunks;
@@ -165,6 +246,29 @@ typedef enum {
     _HF_STATE_DYNAMIC_MINIMIZE,
 } fuzzState_t;
 
+/* Input field kept consistent with the rest of the input after mutations (--fixup_fields) */
+typedef struct {
+    enum {
+        _HF_FIELD_LEN = 0,  /* field = input size - adj */
+        _HF_FIELD_CRC32 = 1, /* field = CRC-32 of [start, end), or of [start, EOF) if toEof */
+    } type;
+    /* Trailing fields (atEof) stay at the end of the input, and checksum data up to them */
+    bool atEof;
+    uint32_t off;
+    uint32_t width;
+    bool bigEndian;
+    uint32_t adj;
+    uint32_t start;
+    uint32_t end;
+    bool toEof;
+} inputField_t;
+
+/* Content-defined point of an input (hash of the 4 bytes at off), where splices are aligned to */
+typedef struct {
+    uint32_t hash;
+    uint32_t off;
+} spliceAnchor_t;
+
 struct _dynfile_t {
     size_t size;
     uint64_t cov[4];
@@ -173,11 +277,69 @@ struct _dynfile_t {
     uint64_t timeExecMillis;
     char path[PATH_MAX];
     uint8_t* data;
+    inputField_t fields[_HF_FIELDS_MAX];
+    size_t fieldsCnt;
+    /* Start offsets of tokens of the input (--mutate_tokens) */
+    uint32_t* tokens;
+    size_t tokensCnt;
+    /* Coverage sketch of the input, and its splice anchors sorted by hash (--splice_aligned) */
+    uint64_t covSig[_HF_COV_SIG_WORDS];
+    spliceAnchor_t* anchors;
+    size_t anchorsCnt;
+    uint32_t anchorsMask;
+    /* To be mutated by LLVMFuzzerCustomMutator/CustomCrossOver() of the fuzzed process */
+    bool customMutate;
+    size_t crossOverLen;
+    /* To be created by the fuzzed process from a seed in the shared corpus (--persistent_mangle) */
+    bool childMangle;
+    const uint8_t* seedData;
+    size_t seedSize;
+    uint64_t mangleSeed;
+    unsigned mangleChangesCnt;
+    /* Hash of the input, added to the dedup filter of the thread once it's launched (0: none) */
+    uint64_t dedupCrc;
     TAILQ_ENTRY(_dynfile_t) pointers;
 };
 
 typedef struct _dynfile_t dynfile_t;
 
+/* Input corpus file read into memory in advance */
+typedef struct {
+    char* name;
+    uint8_t* data;
+    size_t size;
+} inputfile_t;
+
+/* Input waiting to be re-run with the sanitizer build of the target */
+typedef struct _sanInput_t {
+    uint8_t* data;
+    size_t size;
+    bool crashed;
+    TAILQ_ENTRY(_sanInput_t) pointers;
+} sanInput_t;
+
+/* Crash waiting to be re-run by the verifier threads */
+typedef struct _verifyJob_t {
+    uint8_t* data;
+    size_t size;
+    uint64_t backtrace;
+    char crashFileName[PATH_MAX];
+    unsigned iterStarted;
+    unsigned iterDone;
+    bool mismatch;
+    bool queued;
+    TAILQ_ENTRY(_verifyJob_t) pointers;
+} verifyJob_t;
+
+/* Outcome of a single corpus file in the replay mode */
+typedef struct {
+    char* name;
+    size_t size;
+    uint64_t timeMillis;
+    bool crashed;
+    bool tmOut;
+} replayResult_t;
+
 struct strings_t {
     size_t len;
     TAILQ_ENTRY(strings_t) pointers;
@@ -192,6 +354,33 @@ typedef struct {
     uint64_t pidFeedbackEdge[_HF_THREAD_MAX];
     uint64_t pidFeedbackCmp[_HF_THREAD_MAX];
     uint64_t guardNb;
+    /* Equal operands of non-constant comparisons, i.e. of validation checks which passed */
+    bool cmpEqLog;
+    struct {
+        uint32_t cnt;
+        uint32_t val[_HF_CMP_EQ_MAX];
+    } cmpEq[_HF_THREAD_MAX];
+    /* Bloom filter of a sample of code locations covered by the current input */
+    bool covSigLog;
+    uint64_t covSig[_HF_THREAD_MAX][_HF_COV_SIG_WORDS];
+    /* Edges seen in distinct calling contexts (hashes of the call stack) */
+    bool ctxCovLog;
+    uint8_t ctxMap[_HF_CTX_MAP_SIZE];
+    /* Bucketed max stack depth reached by persistent-mode inputs (=stack-depth) */
+    uint32_t stackDepthMax;
+    /* Set by persistent processes which define LLVMFuzzerCustomMutator/CustomCrossOver() */
+    bool customMutator;
+    bool customCrossOver;
+    /* Parameters of inputs mutated by the fuzzed process itself */
+    struct {
+        uint64_t crossOverLen; /* Size of the 2nd input, following the 1st one */
+        uint64_t size;         /* Size of the input after the mutation, set by the fuzzed process */
+        uint64_t seed;
+        uint64_t corpusOff; /* Offset of the seed in the shared corpus (--persistent_mangle) */
+        uint64_t maxSize;
+        uint32_t changesCnt;
+        bool printable;
+    } childMut[_HF_THREAD_MAX];
 } feedback_t;
 
 typedef struct {
@@ -206,6 +395,7 @@ typedef struct {
     struct {
         size_t threadsMax;
         size_t threadsFinished;
+        size_t childrenPerThread;
         uint32_t threadsActiveCnt;
         pthread_t mainThread;
         pid_t mainPid;
@@ -231,6 +421,10 @@ typedef struct {
         dynfile_t* dynfileq2Current;
         TAILQ_HEAD(dyns_t, _dynfile_t) dynfileq;
         bool exportFeedback;
+        bool preload;
+        inputfile_t* preloaded;
+        size_t preloadedCnt;
+        size_t preloadedCurrent;
     } io;
     struct {
         int argc;
@@ -242,6 +436,9 @@ typedef struct {
         const char* feedbackMutateCommand;
         bool netDriver;
         bool persistent;
+        uint64_t persistentMaxRss;
+        unsigned persistentMaxSlowdown;
+        bool persistentWatchdog;
         uint64_t asLimit;
         uint64_t rssLimit;
         uint64_t dataLimit;
@@ -270,6 +467,25 @@ typedef struct {
         size_t mutationsMax;
         unsigned mutationsPerRun;
         size_t maxInputSz;
+        bool fixupFields;
+        bool mutateTokens;
+        bool spliceAligned;
+        /* Corpus inputs kept in a mapping shared with persistent processes (--persistent_mangle) */
+        bool childMangle;
+        int corpusFd;
+        uint8_t* corpusMap;
+        size_t corpusUsed;
+        /* Tokens seen in the corpus: a hash table, and indices of its used slots */
+        struct {
+            struct {
+                uint8_t val[_HF_TOKEN_MAX_LEN];
+                uint32_t len;
+                uint32_t cnt;
+            } tab[_HF_TOKENS_MAX];
+            uint32_t used[_HF_TOKENS_MAX];
+            size_t usedCnt;
+            pthread_rwlock_t rwlock;
+        } tokens;
     } mutate;
     struct {
         bool useScreen;
@@ -289,7 +505,22 @@ typedef struct {
     struct {
         bool enable;
         bool del_report;
+        /* Sanitizer build of the target, which confirms crashes and new inputs of the main one */
+        int argc;
+        const char* const* cmdline;
+        pthread_t thread;
+        pthread_mutex_t queue_mutex;
+        pthread_cond_t queue_cond;
+        TAILQ_HEAD(sanq_t, _sanInput_t) queue;
+        size_t queueCnt;
     } sanitizer;
+    struct {
+        pthread_t threads[_HF_VERIFIER_THREADS];
+        uint32_t threadsActiveCnt;
+        pthread_mutex_t queue_mutex;
+        pthread_cond_t queue_cond;
+        TAILQ_HEAD(verq_t, _verifyJob_t) queue;
+    } verifier;
     struct {
         fuzzState_t state;
         feedback_t* covFeedbackMap;
@@ -298,6 +529,7 @@ typedef struct {
         cmpfeedback_t* cmpFeedbackMap;
         int cmpFeedbackFd;
         bool cmpFeedback;
+        bool ctxCov;
         const char* blacklistFile;
         uint64_t* blacklist;
         size_t blacklistCnt;
@@ -311,12 +543,22 @@ typedef struct {
         size_t verifiedCrashesCnt;
         size_t blCrashesCnt;
         size_t timeoutedCnt;
+        size_t dupSkippedCnt;
+        size_t sanUnconfirmedCnt;
+        size_t recycledCnt;
     } cnts;
     struct {
         bool enabled;
         int serverSocket;
         int clientSocket;
     } socketFuzzer;
+    struct {
+        bool enabled;
+        const char* resultsFile;
+        pthread_mutex_t results_mutex;
+        replayResult_t* results;
+        size_t resultsCnt;
+    } replay;
     /* For the Linux code */
     struct {
         int exeFd;
@@ -333,6 +575,19 @@ typedef struct {
         uintptr_t cloneFlags;
         bool kernelOnly;
         bool useClone;
+        bool useSnapshot;
+        size_t spareChildren;
+        const char* cgroupDir;
+        uint64_t cgroupPidsMax;
+        uint64_t cgroupCpuPct;
+        struct {
+            bpBlock_t* blocks;
+            size_t blocksCnt;
+            uint8_t* hitMap;
+            uint64_t loadVma;
+            dev_t dev;
+            ino_t ino;
+        } bp;
     } linux;
     /* For the NetBSD code */
     struct {
@@ -351,12 +606,15 @@ typedef enum {
     _HF_RS_WAITING_FOR_INITIAL_READY = 1,
     _HF_RS_WAITING_FOR_READY = 2,
     _HF_RS_SEND_DATA = 3,
+    _HF_RS_RECYCLING = 4,
 } runState_t;
 
 typedef struct {
     honggfuzz_t* global;
     pid_t pid;
     int64_t timeStartedMillis;
+    /* When the input was passed to the fuzzed process, i.e. without the time to prepare it */
+    int64_t timeExecStartedMillis;
     char crashFileName[PATH_MAX];
     uint64_t pc;
     uint64_t backtrace;
@@ -364,14 +622,42 @@ typedef struct {
     int exception;
     char report[_HF_REPORT_SIZE];
     bool mainWorker;
+    bool isSanitizerBuild;
+    bool isVerifier;
     unsigned mutationsPerRun;
     dynfile_t* dynfile;
+    dynfile_t* dynfileNext;
+    bool dynfileNextReady;
+    size_t dynfileNextCorpusCnt;
+    /* Position of input_getSpliceInput() in the corpus, so it doesn't move the shared one */
+    const dynfile_t* spliceCurrent;
+    unsigned dynfileNo;
     bool staticFileTryMore;
+    const inputfile_t* preloadedFile;
     uint32_t fuzzNo;
     int persistentSock;
+    /* Pre-forked processes, waiting for the input file descriptor before execve() */
+    struct {
+        pid_t pid;
+        int sock;
+    } spares[_HF_SPARES_MAX];
+    size_t sparesCnt;
     bool waitingForReady;
     runState_t runState;
+    /* Health of the current persistent process, see subproc_persistentShouldRecycle() */
+    struct {
+        uint64_t rounds;
+        int64_t roundStartUSecs;
+        uint64_t baseUSecs;
+        uint64_t avgUSecs;
+        uint64_t rssKiB;
+        /* The largest RSS growth caused by a single input, see subproc_persistentSaveMemGrowth() */
+        uint64_t maxGrowthKiB;
+    } recycle;
     bool tmOutSignaled;
+    bool crashed;
+    uint64_t* dedupBloom;
+    size_t dedupBloomCnt;
     char* args[_HF_ARGS_MAX + 1];
 #if !defined(_HF_ARCH_DARWIN)
     timer_t timerId;
@@ -385,6 +671,19 @@ typedef struct {
         int cpuInstrFd;
         int cpuBranchFd;
         int cpuIptBtsFd;
+        pid_t bpPid;
+        uint64_t bpBase;
+        /* Pidfd of the fuzzed process (if forked with clone3), see subproc_kill() */
+        int pidFd;
+        /* Files of the cgroup of this run (--linux_cgroup), or -1 */
+        int cgroupProcsFd;
+        int cgroupKillFd;
+        int cgroupPeakFd;
+        /* State of arch_reapChildren(), kept in the first run of the fuzzing thread */
+        int reapEpollFd;
+        int reapSigFd;
+        pid_t* reapPids;
+        size_t reapPidsCnt;
     } linux;
 
     struct {
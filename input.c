@@ -40,6 +40,7 @@
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
+#include "libhfcommon/mutate.h"
 #include "libhfcommon/util.h"
 #include "mangle.h"
 #include "subproc.h"
@@ -60,7 +61,22 @@ void input_setSize(run_t* run, size_t sz) {
     run->dynfile->size = sz;
 }
 
+static void input_setMaxInputSz(honggfuzz_t* hfuzz) {
+    if (hfuzz->io.maxFileSz) {
+        hfuzz->mutate.maxInputSz = hfuzz->io.maxFileSz;
+    } else if (hfuzz->mutate.maxInputSz < _HF_INPUT_DEFAULT_SIZE) {
+        hfuzz->mutate.maxInputSz = _HF_INPUT_DEFAULT_SIZE;
+    } else if (hfuzz->mutate.maxInputSz > _HF_INPUT_MAX_SIZE) {
+        hfuzz->mutate.maxInputSz = _HF_INPUT_MAX_SIZE;
+    }
+}
+
 bool input_getDirStatsAndRewind(honggfuzz_t* hfuzz) {
+    if (hfuzz->io.preload) {
+        ATOMIC_SET(hfuzz->io.preloadedCurrent, 0);
+        return true;
+    }
+
     rewinddir(hfuzz->io.inputDirPtr);
 
     size_t fileCnt = 0U;
@@ -103,13 +119,7 @@ bool input_getDirStatsAndRewind(honggfuzz_t* hfuzz) {
     }
 
     ATOMIC_SET(hfuzz->io.fileCnt, fileCnt);
-    if (hfuzz->io.maxFileSz) {
-        hfuzz->mutate.maxInputSz = hfuzz->io.maxFileSz;
-    } else if (hfuzz->mutate.maxInputSz < _HF_INPUT_DEFAULT_SIZE) {
-        hfuzz->mutate.maxInputSz = _HF_INPUT_DEFAULT_SIZE;
-    } else if (hfuzz->mutate.maxInputSz > _HF_INPUT_MAX_SIZE) {
-        hfuzz->mutate.maxInputSz = _HF_INPUT_MAX_SIZE;
-    }
+    input_setMaxInputSz(hfuzz);
 
     if (hfuzz->io.fileCnt == 0U) {
         LOG_W("No usable files in the input directory '%s'", hfuzz->io.inputDir);
@@ -123,8 +133,34 @@ bool input_getDirStatsAndRewind(honggfuzz_t* hfuzz) {
     return true;
 }
 
+static pthread_mutex_t input_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const inputfile_t* input_getNextPreloaded(run_t* run, bool rewind) {
+    MX_SCOPED_LOCK(&input_mutex);
+
+    if (run->global->io.preloadedCnt == 0U) {
+        LOG_W("No useful files in the input directory");
+        return NULL;
+    }
+    if (run->global->io.preloadedCurrent >= run->global->io.preloadedCnt) {
+        if (!rewind) {
+            return NULL;
+        }
+        run->global->io.preloadedCurrent = 0;
+    }
+    return &run->global->io.preloaded[run->global->io.preloadedCurrent++];
+}
+
 bool input_getNext(run_t* run, char fname[PATH_MAX], bool rewind) {
-    static pthread_mutex_t input_mutex = PTHREAD_MUTEX_INITIALIZER;
+    if (run->global->io.preload) {
+        const inputfile_t* file = input_getNextPreloaded(run, rewind);
+        if (!file) {
+            return false;
+        }
+        snprintf(fname, PATH_MAX, "%s", file->name);
+        return true;
+    }
+
     MX_SCOPED_LOCK(&input_mutex);
 
     if (run->global->io.fileCnt == 0U) {
@@ -169,6 +205,138 @@ bool input_getNext(run_t* run, char fname[PATH_MAX], bool rewind) {
     }
 }
 
+typedef struct {
+    honggfuzz_t* hfuzz;
+    int dirFd;
+    size_t nextIdx;
+} preloadCtx_t;
+
+static void* input_preloadThread(void* arg) {
+    preloadCtx_t* ctx = (preloadCtx_t*)arg;
+    honggfuzz_t* hfuzz = ctx->hfuzz;
+    size_t maxSz = hfuzz->io.maxFileSz ? hfuzz->io.maxFileSz : _HF_INPUT_MAX_SIZE;
+
+    for (;;) {
+        size_t idx = ATOMIC_POST_INC(ctx->nextIdx);
+        if (idx >= hfuzz->io.preloadedCnt) {
+            return NULL;
+        }
+        inputfile_t* file = &hfuzz->io.preloaded[idx];
+
+        int fd = TEMP_FAILURE_RETRY(openat(ctx->dirFd, file->name, O_RDONLY | O_CLOEXEC));
+        if (fd == -1) {
+            PLOG_W("Couldn't open '%s/%s'", hfuzz->io.inputDir, file->name);
+            continue;
+        }
+        defer {
+            close(fd);
+        };
+
+        struct stat st;
+        if (fstat(fd, &st) == -1) {
+            PLOG_W("Couldn't stat() the '%s/%s' file", hfuzz->io.inputDir, file->name);
+            continue;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            LOG_D("'%s/%s' is not a regular file, skipping", hfuzz->io.inputDir, file->name);
+            continue;
+        }
+
+        size_t sz = HF_MIN((size_t)st.st_size, maxSz);
+        uint8_t* data = (uint8_t*)util_Malloc(sz ? sz : 1);
+        ssize_t rsz = files_readFromFd(fd, data, sz);
+        if (rsz < 0) {
+            LOG_W("Couldn't read contents of '%s/%s'", hfuzz->io.inputDir, file->name);
+            free(data);
+            continue;
+        }
+        file->size = (size_t)rsz;
+        file->data = data;
+    }
+}
+
+/*
+ * Enumerates the input directory once (d_type saves a stat() per entry), and reads all files
+ * with a pool of threads, so the latency of open()/read() on slow (e.g. network) file-systems
+ * is paid in parallel
+ */
+static bool input_preloadCorpus(honggfuzz_t* hfuzz) {
+    size_t cnt = 0;
+    size_t capacity = 0;
+    for (;;) {
+        errno = 0;
+        struct dirent* entry = readdir(hfuzz->io.inputDirPtr);
+        if (entry == NULL && errno == EINTR) {
+            continue;
+        }
+        if (entry == NULL && errno != 0) {
+            PLOG_W("readdir('%s')", hfuzz->io.inputDir);
+            return false;
+        }
+        if (entry == NULL) {
+            break;
+        }
+        if (entry->d_type != DT_REG && entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN) {
+            continue;
+        }
+        if (cnt == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            hfuzz->io.preloaded =
+                (inputfile_t*)util_Realloc(hfuzz->io.preloaded, capacity * sizeof(inputfile_t));
+        }
+        hfuzz->io.preloaded[cnt].name = util_StrDup(entry->d_name);
+        hfuzz->io.preloaded[cnt].data = NULL;
+        hfuzz->io.preloaded[cnt].size = 0;
+        cnt++;
+    }
+    hfuzz->io.preloadedCnt = cnt;
+
+    preloadCtx_t ctx = {
+        .hfuzz = hfuzz,
+        .dirFd = dirfd(hfuzz->io.inputDirPtr),
+        .nextIdx = 0,
+    };
+    size_t threadsCnt = HF_MAX(HF_MIN(cnt, (size_t)_HF_PRELOAD_THREADS), (size_t)1);
+    pthread_t threads[_HF_PRELOAD_THREADS];
+    for (size_t i = 0; i < threadsCnt; i++) {
+        if (pthread_create(&threads[i], NULL, input_preloadThread, &ctx) != 0) {
+            PLOG_F("Couldn't create a new thread");
+        }
+    }
+    for (size_t i = 0; i < threadsCnt; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Drop entries which turned out not to be readable regular files */
+    size_t loaded = 0;
+    size_t totalSz = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        inputfile_t* file = &hfuzz->io.preloaded[i];
+        if (file->data == NULL) {
+            free(file->name);
+            continue;
+        }
+        if (file->size > hfuzz->mutate.maxInputSz) {
+            hfuzz->mutate.maxInputSz = file->size;
+        }
+        totalSz += file->size;
+        hfuzz->io.preloaded[loaded++] = *file;
+    }
+    hfuzz->io.preloadedCnt = loaded;
+    hfuzz->io.preloadedCurrent = 0;
+
+    ATOMIC_SET(hfuzz->io.fileCnt, loaded);
+    input_setMaxInputSz(hfuzz);
+
+    if (hfuzz->io.fileCnt == 0U) {
+        LOG_W("No usable files in the input directory '%s'", hfuzz->io.inputDir);
+    }
+    LOG_I("Preloaded %zu files (%zu bytes) from '%s' with %zu threads", loaded, totalSz,
+        hfuzz->io.inputDir, threadsCnt);
+
+    return true;
+}
+
 bool input_init(honggfuzz_t* hfuzz) {
     hfuzz->io.fileCnt = 0U;
 
@@ -187,6 +355,9 @@ bool input_init(honggfuzz_t* hfuzz) {
         close(dir_fd);
         return false;
     }
+    if (hfuzz->io.preload) {
+        return input_preloadCorpus(hfuzz);
+    }
     if (input_getDirStatsAndRewind(hfuzz) == false) {
         hfuzz->io.fileCnt = 0U;
         LOG_W("input_getDirStatsAndRewind('%s')", hfuzz->io.inputDir);
@@ -372,16 +543,40 @@ static bool input_cmpCov(dynfile_t* item1, dynfile_t* item2) {
 #define TAILQ_FOREACH_HF(var, head, field) \
     for ((var) = TAILQ_FIRST((head)); (var); (var) = TAILQ_NEXT((var), field))
 
+/*
+ * With --persistent_mangle, corpus inputs are appended to the mapping shared with persistent
+ * processes, so they can create new inputs from them. Once it's full, they go to the heap
+ */
+static uint8_t* input_allocCorpusData(run_t* run, size_t sz) {
+    if (run->global->mutate.childMangle) {
+        size_t off = ATOMIC_POST_ADD(run->global->mutate.corpusUsed, sz);
+        if (sz <= _HF_CORPUS_MAP_SIZE && off <= (_HF_CORPUS_MAP_SIZE - sz)) {
+            return &run->global->mutate.corpusMap[off];
+        }
+    }
+    return (uint8_t*)util_Malloc(sz);
+}
+
+static bool input_inCorpusMap(run_t* run, const dynfile_t* dynfile) {
+    const uint8_t* map = run->global->mutate.corpusMap;
+    return map && dynfile->data >= map && dynfile->data < &map[_HF_CORPUS_MAP_SIZE];
+}
+
 void input_addDynamicInput(run_t* run) {
     ATOMIC_SET(run->global->timing.lastCovUpdate, time(NULL));
 
+    input_syncChildMutation(run);
+
     dynfile_t* dynfile = (dynfile_t*)util_Malloc(sizeof(dynfile_t));
     dynfile->size = run->dynfile->size;
     memcpy(dynfile->cov, run->dynfile->cov, sizeof(dynfile->cov));
     dynfile->timeExecMillis = util_timeNowMillis() - run->timeStartedMillis;
-    dynfile->data = (uint8_t*)util_Malloc(run->dynfile->size);
+    dynfile->data = input_allocCorpusData(run, run->dynfile->size);
     memcpy(dynfile->data, run->dynfile->data, run->dynfile->size);
     input_generateFileName(dynfile, NULL, dynfile->path);
+    mangle_inferFields(run, dynfile);
+    mangle_tokenize(run, dynfile);
+    mangle_spliceIndex(run, dynfile);
 
     MX_SCOPED_RWLOCK_WRITE(&run->global->io.dynfileq_mutex);
 
@@ -462,6 +657,162 @@ static bool input_trySlowInput(unsigned slow_factor) {
     return ((util_rnd64() % slow_factor) == 0);
 }
 
+/*
+ * Approximate set of inputs recently executed by this thread: a bloom filter with two probes,
+ * which is cleared once it becomes too crowded (1/32 of bits set) to keep false positives rare
+ */
+static bool input_dedupSeenBefore(run_t* run, uint64_t crc) {
+    uint32_t h1 = (uint32_t)crc % _HF_DEDUP_BLOOM_BITS;
+    uint32_t h2 = (uint32_t)(crc >> 32) % _HF_DEDUP_BLOOM_BITS;
+
+    const uint64_t* bloom = run->dedupBloom;
+    return (bloom[h1 / 64] & (1ULL << (h1 % 64))) && (bloom[h2 / 64] & (1ULL << (h2 % 64)));
+}
+
+/*
+ * Called once the input is actually launched, so speculatively prepared inputs which are discarded
+ * later don't make identical mutations look like duplicates
+ */
+void input_dedupAdd(run_t* run) {
+    uint64_t crc = run->dynfile->dedupCrc;
+    if (crc == 0) {
+        return;
+    }
+    run->dynfile->dedupCrc = 0;
+
+    uint32_t h1 = (uint32_t)crc % _HF_DEDUP_BLOOM_BITS;
+    uint32_t h2 = (uint32_t)(crc >> 32) % _HF_DEDUP_BLOOM_BITS;
+
+    uint64_t* bloom = run->dedupBloom;
+    if (run->dedupBloomCnt >= (_HF_DEDUP_BLOOM_BITS / 32)) {
+        memset(bloom, '\0', _HF_DEDUP_BLOOM_BITS / 8);
+        run->dedupBloomCnt = 0;
+    }
+    bloom[h1 / 64] |= (1ULL << (h1 % 64));
+    bloom[h2 / 64] |= (1ULL << (h2 % 64));
+    run->dedupBloomCnt++;
+}
+
+static void input_loadDynamicInputMeta(run_t* run, const dynfile_t* current) {
+    memcpy(run->dynfile->cov, current->cov, sizeof(run->dynfile->cov));
+    memcpy(run->dynfile->covSig, current->covSig, sizeof(run->dynfile->covSig));
+    run->dynfile->idx = current->idx;
+    run->dynfile->timeExecMillis = current->timeExecMillis;
+    snprintf(run->dynfile->path, sizeof(run->dynfile->path), "%s", current->path);
+}
+
+static void input_loadDynamicInput(run_t* run, dynfile_t* current) {
+    input_setSize(run, current->size);
+    input_loadDynamicInputMeta(run, current);
+    memcpy(run->dynfile->data, current->data, current->size);
+}
+
+/*
+ * With --persistent_mangle, the persistent process creates the input itself, from the seed in the
+ * shared corpus, with mutate_Buf(). Nothing is written to the input file, it's re-created from the
+ * seed with input_syncChildMutation() only if the input turns out to be interesting
+ */
+static bool input_prepareChildMangle(run_t* run, dynfile_t* current, unsigned slow_factor) {
+    feedback_t* fb = run->global->feedback.covFeedbackMap;
+    if (!run->global->mutate.childMangle || !input_inCorpusMap(run, current)) {
+        return false;
+    }
+    /* Custom mutators of the fuzzed process take precedence */
+    if (ATOMIC_GET(fb->customMutator) || ATOMIC_GET(fb->customCrossOver)) {
+        return false;
+    }
+
+    input_loadDynamicInputMeta(run, current);
+    run->dynfile->childMangle = true;
+    run->dynfile->seedData = current->data;
+    run->dynfile->seedSize = current->size;
+    run->dynfile->mangleSeed = util_rnd64();
+    run->dynfile->mangleChangesCnt = mangle_changesCnt(run, slow_factor);
+    return true;
+}
+
+/*
+ * Persistent processes defining LLVMFuzzerCustomMutator/CustomCrossOver() mutate inputs themselves
+ * (see libhfuzz/persistent.c), and run them right away. The mutated input is written back to the
+ * input file, so it's only copied out of it (e.g. to the corpus) if it turns out to be interesting
+ */
+static bool input_prepareCustomMutation(run_t* run, dynfile_t* current) {
+    feedback_t* fb = run->global->feedback.covFeedbackMap;
+    if (!run->global->exe.persistent) {
+        return false;
+    }
+
+    const uint8_t* other = NULL;
+    size_t crossOverLen = 0;
+    if (ATOMIC_GET(fb->customCrossOver) && util_rndGet(0, 3) == 0) {
+        crossOverLen = input_getRandomInputAsBuf(run, &other);
+        if ((current->size + crossOverLen) > run->global->mutate.maxInputSz) {
+            crossOverLen = 0;
+        }
+    }
+    if (!crossOverLen && !ATOMIC_GET(fb->customMutator)) {
+        return false;
+    }
+
+    /* The fuzzed process can grow the input up to maxInputSz, so the file must be that big */
+    input_setSize(run, run->global->mutate.maxInputSz);
+    run->dynfile->size = current->size;
+    if (crossOverLen) {
+        memcpy(&run->dynfile->data[current->size], other, crossOverLen);
+    }
+    run->dynfile->customMutate = true;
+    run->dynfile->crossOverLen = crossOverLen;
+    return true;
+}
+
+/*
+ * Re-creates the input created by the fuzzed process from a corpus seed (--persistent_mangle). It
+ * must give the same input, as both sides use mutate_Buf() with the same arguments
+ */
+static void input_syncChildMangle(run_t* run) {
+    run->dynfile->childMangle = false;
+
+    input_setSize(run, run->global->mutate.maxInputSz);
+    memcpy(run->dynfile->data, run->dynfile->seedData, run->dynfile->seedSize);
+    size_t sz = mutate_Buf(run->dynfile->data, run->dynfile->seedSize,
+        run->global->mutate.maxInputSz, run->dynfile->mangleSeed, run->dynfile->mangleChangesCnt,
+        run->global->cfg.only_printable);
+    input_setSize(run, sz);
+
+    size_t childSz =
+        (size_t)ATOMIC_GET(run->global->feedback.covFeedbackMap->childMut[run->fuzzNo].size);
+    if (childSz != sz) {
+        LOG_W("The input re-created from the seed (size: %zu) differs from the one created by the "
+              "fuzzed process (size: %zu)",
+            sz, childSz);
+    }
+}
+
+/*
+ * Picks up the input mutated by the fuzzed process (if it was). It's done only when the input is
+ * needed, i.e. when it's saved
+ */
+void input_syncChildMutation(run_t* run) {
+    if (run->dynfile->childMangle) {
+        input_syncChildMangle(run);
+        return;
+    }
+    if (!run->dynfile->customMutate) {
+        return;
+    }
+    run->dynfile->customMutate = false;
+
+    size_t sz =
+        (size_t)ATOMIC_GET(run->global->feedback.covFeedbackMap->childMut[run->fuzzNo].size);
+    if (sz > run->global->mutate.maxInputSz) {
+        LOG_W("The fuzzed process returned an input of invalid size: %zu", sz);
+        sz = run->dynfile->size;
+    }
+    /* The real size of the file, see input_prepareCustomMutation() */
+    run->dynfile->size = run->global->mutate.maxInputSz;
+    input_setSize(run, sz);
+}
+
 bool input_prepareDynamicInput(run_t* run, bool needs_mangle) {
     dynfile_t* current = NULL;
 
@@ -469,6 +820,8 @@ bool input_prepareDynamicInput(run_t* run, bool needs_mangle) {
         LOG_F("The dynamic file corpus is empty. This shouldn't happen");
     }
 
+    run->dynfile->dedupCrc = 0;
+
     unsigned slow_factor = 0;
     for (;;) {
         MX_SCOPED_RWLOCK_WRITE(&run->global->io.dynfileq_mutex);
@@ -486,15 +839,42 @@ bool input_prepareDynamicInput(run_t* run, bool needs_mangle) {
         }
     }
 
-    input_setSize(run, current->size);
-    memcpy(run->dynfile->cov, current->cov, sizeof(run->dynfile->cov));
-    run->dynfile->idx = current->idx;
-    run->dynfile->timeExecMillis = current->timeExecMillis;
-    snprintf(run->dynfile->path, sizeof(run->dynfile->path), "%s", current->path);
-    memcpy(run->dynfile->data, current->data, current->size);
+    if (needs_mangle && input_prepareChildMangle(run, current, slow_factor)) {
+        return true;
+    }
+    input_loadDynamicInput(run, current);
 
-    if (needs_mangle) {
-        mangle_mangleContent(run, slow_factor);
+    if (!needs_mangle) {
+        return true;
+    }
+    if (input_prepareCustomMutation(run, current)) {
+        return true;
+    }
+
+    /*
+     * Stacked mutations can cancel each other out (e.g. shrink+expand), or re-create an input
+     * which was just tested. Re-roll those instead of wasting a full execution of the target
+     */
+    for (unsigned i = 0;; i++) {
+        if (!mangle_mangleTokens(run, current)) {
+            mangle_mangleContent(run, slow_factor);
+        }
+        mangle_fixupFields(run, current);
+
+        bool isSeed = (run->dynfile->size == current->size) &&
+                      (memcmp(run->dynfile->data, current->data, current->size) == 0);
+        if (!isSeed) {
+            uint64_t crc = util_CRC64(run->dynfile->data, run->dynfile->size) ^ run->dynfile->size;
+            if (!input_dedupSeenBefore(run, crc)) {
+                run->dynfile->dedupCrc = crc;
+                break;
+            }
+        }
+        if (i >= _HF_DEDUP_MAX_REROLLS) {
+            break;
+        }
+        ATOMIC_POST_INC(run->global->cnts.dupSkippedCnt);
+        input_loadDynamicInput(run, current);
     }
 
     return true;
@@ -523,8 +903,56 @@ size_t input_getRandomInputAsBuf(run_t* run, const uint8_t** buf) {
     return current->size;
 }
 
+/* Number of (sampled) code locations covered by both inputs, relative to those covered by either */
+static uint64_t input_covSimilarity(const dynfile_t* a, const dynfile_t* b) {
+    uint64_t both = 0, either = 0;
+    for (size_t i = 0; i < ARRAYSIZE(a->covSig); i++) {
+        both += __builtin_popcountll(a->covSig[i] & b->covSig[i]);
+        either += __builtin_popcountll(a->covSig[i] | b->covSig[i]);
+    }
+    return (both * 1024) / (either + 1);
+}
+
+/*
+ * Splice partner for the current input: the one with the most similar code coverage out of a few
+ * corpus inputs. Corpus inputs are never removed, so the pointer stays valid
+ */
+const dynfile_t* input_getSpliceInput(run_t* run) {
+    if (ATOMIC_GET(run->global->io.dynfileqCnt) == 0) {
+        return NULL;
+    }
+
+    MX_SCOPED_RWLOCK_READ(&run->global->io.dynfileq_mutex);
+
+    const dynfile_t* best = NULL;
+    uint64_t bestScore = 0;
+    for (unsigned i = 0; i < _HF_SPLICE_CANDIDATES; i++) {
+        for (uint64_t skip = util_rndGet(1, 8); skip > 0; skip--) {
+            if (run->spliceCurrent == NULL) {
+                run->spliceCurrent = TAILQ_FIRST(&run->global->io.dynfileq);
+            }
+            run->spliceCurrent = TAILQ_NEXT(run->spliceCurrent, pointers);
+        }
+        if (run->spliceCurrent == NULL) {
+            run->spliceCurrent = TAILQ_FIRST(&run->global->io.dynfileq);
+        }
+
+        const dynfile_t* cand = run->spliceCurrent;
+        /* The input itself has the same coverage, but splicing with it is mostly useless */
+        uint64_t score =
+            (cand->idx == run->dynfile->idx) ? 0 : input_covSimilarity(run->dynfile, cand) + 1;
+        if (best == NULL || score > bestScore) {
+            best = cand;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
 static bool input_shouldReadNewFile(run_t* run) {
-    if (fuzz_getState(run->global) != _HF_STATE_DYNAMIC_DRY_RUN) {
+    /* The replay mode runs every file exactly once, with its whole content */
+    if (fuzz_getState(run->global) != _HF_STATE_DYNAMIC_DRY_RUN || run->global->replay.enabled) {
         input_setSize(run, run->global->mutate.maxInputSz);
         return true;
     }
@@ -548,10 +976,40 @@ static bool input_shouldReadNewFile(run_t* run) {
     return false;
 }
 
+static bool input_getNextStaticFile(run_t* run, bool rewind) {
+    if (!run->global->io.preload) {
+        return input_getNext(run, run->dynfile->path, rewind);
+    }
+
+    run->preloadedFile = input_getNextPreloaded(run, rewind);
+    if (!run->preloadedFile) {
+        return false;
+    }
+    snprintf(run->dynfile->path, sizeof(run->dynfile->path), "%s", run->preloadedFile->name);
+    return true;
+}
+
+static ssize_t input_readStaticFile(run_t* run) {
+    if (run->global->io.preload) {
+        size_t sz = HF_MIN(run->preloadedFile->size, run->dynfile->size);
+        memcpy(run->dynfile->data, run->preloadedFile->data, sz);
+        return (ssize_t)sz;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", run->global->io.inputDir, run->dynfile->path);
+
+    ssize_t fileSz = files_readFileToBufMax(path, run->dynfile->data, run->dynfile->size);
+    if (fileSz < 0) {
+        LOG_E("Couldn't read contents of '%s'", path);
+    }
+    return fileSz;
+}
+
 bool input_prepareStaticFile(run_t* run, bool rewind, bool needs_mangle) {
     if (input_shouldReadNewFile(run)) {
         for (;;) {
-            if (!input_getNext(run, run->dynfile->path, /* rewind= */ rewind)) {
+            if (!input_getNextStaticFile(run, /* rewind= */ rewind)) {
                 return false;
             }
             if (needs_mangle || !input_inDynamicCorpus(run, run->dynfile->path)) {
@@ -562,12 +1020,8 @@ bool input_prepareStaticFile(run_t* run, bool rewind, bool needs_mangle) {
         run->global->io.testedFileCnt++;
     }
 
-    char path[PATH_MAX];
-    snprintf(path, sizeof(path), "%s/%s", run->global->io.inputDir, run->dynfile->path);
-
-    ssize_t fileSz = files_readFileToBufMax(path, run->dynfile->data, run->dynfile->size);
+    ssize_t fileSz = input_readStaticFile(run);
     if (fileSz < 0) {
-        LOG_E("Couldn't read contents of '%s'", path);
         return false;
     }
 
@@ -40,7 +40,10 @@ extern void input_addDynamicInput(run_t* run);
 extern bool input_inDynamicCorpus(run_t* run, const char* fname);
 extern void input_renumerateInputs(honggfuzz_t* hfuzz);
 extern bool input_prepareDynamicInput(run_t* run, bool needs_mangle);
+extern void input_dedupAdd(run_t* run);
+extern void input_syncChildMutation(run_t* run);
 extern size_t input_getRandomInputAsBuf(run_t* run, const uint8_t** buf);
+extern const dynfile_t* input_getSpliceInput(run_t* run);
 extern bool input_prepareStaticFile(run_t* run, bool rewind, bool needs_mangle);
 extern void input_removeStaticFile(const char* dir, const char* name);
 extern bool input_prepareExternalFile(run_t* run);
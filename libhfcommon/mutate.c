@@ -0,0 +1,348 @@
+/*
+ *
+ * honggfuzz - deterministic input mutations
+ * -----------------------------------------
+ *
+ * Author: Robert Swiecki <swiecki@google.com>
+ *
+ * Copyright 2010-2018 by Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+ * implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ */
+
+#include "libhfcommon/mutate.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libhfcommon/common.h"
+#include "libhfcommon/util.h"
+
+/*
+ * A subset of the mutations of mangle.c, which doesn't depend on the fuzzer's state (dictionaries,
+ * comparison feedback, other corpus inputs), and uses its own PRNG
+ */
+
+/* Maximum reasonable block size for many types of mutations (but not for all) */
+#define MUTATE_MAX_LEN_BLOCK 512U
+
+typedef struct {
+    uint8_t* buf;
+    size_t size;
+    size_t maxSize;
+    uint64_t rndState;
+    bool printable;
+} mutate_t;
+
+static uint64_t mutate_rnd64(mutate_t* m) {
+    /* splitmix64 */
+    uint64_t z = (m->rndState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t mutate_rndGet(mutate_t* m, uint64_t min, uint64_t max) {
+    return (mutate_rnd64(m) % (max - min + 1)) + min;
+}
+
+static void mutate_rndBuf(mutate_t* m, uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)mutate_rnd64(m);
+    }
+    if (m->printable) {
+        util_turnToPrintable(buf, len);
+    }
+}
+
+/* Random value between <1:max> with x^2 distribution, as in mangle.c */
+static size_t mutate_getLen(mutate_t* m, size_t max) {
+    if (max <= 1) {
+        return 1;
+    }
+    const double rnd = (double)(mutate_rnd64(m) >> 11) / (double)(1ULL << 53);
+    size_t ret = (size_t)(rnd * rnd * (double)max) + 1;
+    return HF_MIN(ret, max);
+}
+
+static size_t mutate_getOffSet(mutate_t* m) {
+    return mutate_getLen(m, m->size) - 1;
+}
+
+static void mutate_Overwrite(mutate_t* m, size_t off, const uint8_t* src, size_t len) {
+    len = HF_MIN(len, m->size - off);
+    memmove(&m->buf[off], src, len);
+    if (m->printable) {
+        util_turnToPrintable(&m->buf[off], len);
+    }
+}
+
+/* Makes space for 'len' bytes at 'off', returns how many bytes were inserted */
+static size_t mutate_Inflate(mutate_t* m, size_t off, size_t len) {
+    len = HF_MIN(len, m->maxSize - m->size);
+    memmove(&m->buf[off + len], &m->buf[off], m->size - off);
+    m->size += len;
+    if (m->printable) {
+        memset(&m->buf[off], ' ', len);
+    }
+    return len;
+}
+
+static void mutate_Insert(mutate_t* m, size_t off, const uint8_t* src, size_t len) {
+    len = mutate_Inflate(m, off, len);
+    mutate_Overwrite(m, off, src, len);
+}
+
+static void mutate_Shrink(mutate_t* m) {
+    if (m->size <= 2U) {
+        return;
+    }
+    size_t off = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(16, m->size - off));
+    if ((mutate_rnd64(m) % 16) == 0) {
+        len = mutate_getLen(m, m->size - off);
+    }
+    if (len >= m->size) {
+        return;
+    }
+    memmove(&m->buf[off], &m->buf[off + len], m->size - off - len);
+    m->size -= len;
+}
+
+static void mutate_Expand(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(16, m->maxSize - off));
+    if ((mutate_rnd64(m) % 16) == 0) {
+        len = mutate_getLen(m, m->maxSize - off);
+    }
+    mutate_Inflate(m, off, len);
+}
+
+static void mutate_Bit(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    m->buf[off] ^= (uint8_t)(1U << mutate_rndGet(m, 0, 7));
+    if (m->printable) {
+        util_turnToPrintable(&m->buf[off], 1);
+    }
+}
+
+static void mutate_IncByte(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    if (m->printable) {
+        m->buf[off] = (m->buf[off] - 32 + 1) % 95 + 32;
+    } else {
+        m->buf[off] += (uint8_t)1UL;
+    }
+}
+
+static void mutate_DecByte(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    if (m->printable) {
+        m->buf[off] = (m->buf[off] - 32 + 94) % 95 + 32;
+    } else {
+        m->buf[off] -= (uint8_t)1UL;
+    }
+}
+
+static void mutate_NegByte(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    if (m->printable) {
+        m->buf[off] = 94 - (m->buf[off] - 32) + 32;
+    } else {
+        m->buf[off] = ~(m->buf[off]);
+    }
+}
+
+/* Adds a small value to a 1/2/4/8-byte integer, of either endianness */
+static void mutate_AddSub(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t varLen = 1U << mutate_rndGet(m, 0, 3);
+    if ((m->size - off) < varLen) {
+        varLen = 1;
+    }
+    static const uint64_t ranges[] = {16, 4096, 1048576, 268435456};
+    uint64_t range = ranges[__builtin_ctz(varLen)];
+    uint64_t delta = mutate_rndGet(m, 0, range * 2) - range;
+    bool swap = mutate_rnd64(m) & 0x1;
+
+    uint64_t val = 0;
+    for (size_t i = 0; i < varLen; i++) {
+        val |= (uint64_t)m->buf[off + (swap ? (varLen - 1 - i) : i)] << (i * 8);
+    }
+    val += delta;
+    uint8_t tmp[8];
+    for (size_t i = 0; i < varLen; i++) {
+        tmp[swap ? (varLen - 1 - i) : i] = (uint8_t)(val >> (i * 8));
+    }
+    mutate_Overwrite(m, off, tmp, varLen);
+}
+
+static void mutate_MemSet(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(MUTATE_MAX_LEN_BLOCK, m->size - off));
+    uint8_t val = (uint8_t)mutate_rnd64(m);
+    if (m->printable) {
+        util_turnToPrintable(&val, 1);
+    }
+    memset(&m->buf[off], val, len);
+}
+
+static void mutate_MemCopyOverwrite(mutate_t* m) {
+    size_t off_from = mutate_getOffSet(m);
+    size_t off_to = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(MUTATE_MAX_LEN_BLOCK, m->size - off_from));
+    mutate_Overwrite(m, off_to, &m->buf[off_from], len);
+}
+
+static void mutate_MemCopyInsert(mutate_t* m) {
+    size_t off_from = mutate_getOffSet(m);
+    size_t off_to = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(MUTATE_MAX_LEN_BLOCK, m->size - off_from));
+    uint8_t tmp[MUTATE_MAX_LEN_BLOCK];
+    memcpy(tmp, &m->buf[off_from], len);
+    mutate_Insert(m, off_to, tmp, len);
+}
+
+static void mutate_BytesOverwrite(mutate_t* m) {
+    uint8_t buf[2];
+    mutate_rndBuf(m, buf, sizeof(buf));
+    size_t off = mutate_getOffSet(m);
+    mutate_Overwrite(m, off, buf, mutate_rndGet(m, 1, 2));
+}
+
+static void mutate_BytesInsert(mutate_t* m) {
+    uint8_t buf[2];
+    mutate_rndBuf(m, buf, sizeof(buf));
+    size_t off = mutate_getOffSet(m);
+    mutate_Insert(m, off, buf, mutate_rndGet(m, 1, 2));
+}
+
+static void mutate_ByteRepeatOverwrite(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t destOff = off + 1;
+    if (destOff >= m->size) {
+        return;
+    }
+    size_t len = mutate_getLen(m, HF_MIN(MUTATE_MAX_LEN_BLOCK, m->size - destOff));
+    memset(&m->buf[destOff], m->buf[off], len);
+}
+
+static void mutate_ByteRepeatInsert(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t destOff = off + 1;
+    size_t len = mutate_getLen(m, MUTATE_MAX_LEN_BLOCK);
+    len = mutate_Inflate(m, destOff, len);
+    memset(&m->buf[destOff], m->buf[off], len);
+}
+
+static void mutate_MagicOverwrite(mutate_t* m) {
+    static const uint64_t magic[] = {
+        0x0ULL,
+        0x1ULL,
+        0x7FULL,
+        0x80ULL,
+        0xFFULL,
+        0x7FFFULL,
+        0x8000ULL,
+        0xFFFFULL,
+        0x7FFFFFFFULL,
+        0x80000000ULL,
+        0xFFFFFFFFULL,
+        0x7FFFFFFFFFFFFFFFULL,
+        0x8000000000000000ULL,
+        0xFFFFFFFFFFFFFFFFULL,
+    };
+    uint64_t val = magic[mutate_rndGet(m, 0, ARRAYSIZE(magic) - 1)];
+    size_t varLen = 1U << mutate_rndGet(m, 0, 3);
+    bool swap = mutate_rnd64(m) & 0x1;
+    uint8_t tmp[8];
+    for (size_t i = 0; i < varLen; i++) {
+        tmp[swap ? (varLen - 1 - i) : i] = (uint8_t)(val >> (i * 8));
+    }
+    size_t off = mutate_getOffSet(m);
+    mutate_Overwrite(m, off, tmp, varLen);
+}
+
+static void mutate_RandomOverwrite(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, HF_MIN(MUTATE_MAX_LEN_BLOCK, m->size - off));
+    mutate_rndBuf(m, &m->buf[off], len);
+}
+
+static void mutate_RandomInsert(mutate_t* m) {
+    size_t off = mutate_getOffSet(m);
+    size_t len = mutate_getLen(m, MUTATE_MAX_LEN_BLOCK);
+    len = mutate_Inflate(m, off, len);
+    mutate_rndBuf(m, &m->buf[off], len);
+}
+
+static void mutate_ASCIINum(mutate_t* m) {
+    char buf[20];
+    snprintf(buf, sizeof(buf), "%-19" PRId64, (int64_t)mutate_rnd64(m));
+    size_t len = mutate_rndGet(m, 2, 8);
+    size_t off = mutate_getOffSet(m);
+    if (mutate_rnd64(m) & 0x1) {
+        mutate_Insert(m, off, (const uint8_t*)buf, len);
+    } else {
+        mutate_Overwrite(m, off, (const uint8_t*)buf, len);
+    }
+}
+
+size_t mutate_Buf(
+    uint8_t* buf, size_t sz, size_t maxSz, uint64_t seed, unsigned changesCnt, bool printable) {
+    static void (*const mutateFuncs[])(mutate_t * m) = {
+        /* Every *Insert or Expand expands file, so add more Shrink's */
+        mutate_Shrink,
+        mutate_Shrink,
+        mutate_Shrink,
+        mutate_Shrink,
+        mutate_Expand,
+        mutate_Bit,
+        mutate_IncByte,
+        mutate_DecByte,
+        mutate_NegByte,
+        mutate_AddSub,
+        mutate_MemSet,
+        mutate_MemCopyOverwrite,
+        mutate_MemCopyInsert,
+        mutate_BytesOverwrite,
+        mutate_BytesInsert,
+        mutate_ByteRepeatOverwrite,
+        mutate_ByteRepeatInsert,
+        mutate_MagicOverwrite,
+        mutate_RandomOverwrite,
+        mutate_RandomInsert,
+        mutate_ASCIINum,
+    };
+
+    if (maxSz == 0) {
+        return 0;
+    }
+    mutate_t m = {
+        .buf = buf,
+        .size = HF_MIN(sz, maxSz),
+        .maxSize = maxSz,
+        .rndState = seed,
+        .printable = printable,
+    };
+    if (m.size == 0) {
+        m.size = mutate_getLen(&m, HF_MIN(maxSz, MUTATE_MAX_LEN_BLOCK));
+        mutate_rndBuf(&m, m.buf, m.size);
+    }
+    for (unsigned x = 0; x < changesCnt; x++) {
+        mutateFuncs[mutate_rndGet(&m, 0, ARRAYSIZE(mutateFuncs) - 1)](&m);
+    }
+    return m.size;
+}
@@ -0,0 +1,39 @@
+/*
+ *
+ * honggfuzz - deterministic input mutations
+ * -----------------------------------------
+ *
+ * Author: Robert Swiecki <swiecki@google.com>
+ *
+ * Copyright 2010-2018 by Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+ * implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ */
+
+#ifndef _HF_COMMON_MUTATE_H_
+#define _HF_COMMON_MUTATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Applies 'changesCnt' byte-level mutations to 'buf' (of 'sz' bytes, which can grow up to 'maxSz'),
+ * and returns its new size. The result depends on the arguments only, so the fuzzer and the fuzzed
+ * process (--persistent_mangle) can both create the same input from a seed input and 'seed'
+ */
+size_t mutate_Buf(
+    uint8_t* buf, size_t sz, size_t maxSz, uint64_t seed, unsigned changesCnt, bool printable);
+
+#endif /* _HF_COMMON_MUTATE_H_ */
@@ -47,6 +47,9 @@
 #define ATOMIC_SET(x, y) __atomic_store_n(&(x), y, __ATOMIC_RELAXED)
 #define ATOMIC_CLEAR(x) __atomic_store_n(&(x), 0, __ATOMIC_RELAXED)
 #define ATOMIC_XCHG(x, y) __atomic_exchange_n(&(x), y, __ATOMIC_RELAXED)
+/* On failure, 'e' is updated with the current value of 'x' */
+#define ATOMIC_CAS(x, e, y) \
+    __atomic_compare_exchange_n(&(x), &(e), y, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
 
 #define ATOMIC_PRE_INC(x) __atomic_add_fetch(&(x), 1, __ATOMIC_RELAXED)
 #define ATOMIC_POST_INC(x) __atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED)
@@ -132,6 +135,7 @@ extern uint64_t util_hash(const char* buf, size_t len);
 extern int64_t fastArray64Search(uint64_t* array, size_t arraySz, uint64_t key);
 
 extern int64_t util_timeNowMillis(void);
+extern int64_t util_timeNowUSecs(void);
 extern void util_sleepForMSec(uint64_t msec);
 
 extern uint64_t util_getUINT32(const uint8_t* buf);
@@ -146,5 +150,6 @@ extern void util_mutexRWUnlock(pthread_rwlock_t* mutex, const char* func, int li
 
 extern uint64_t util_CRC64(const uint8_t* buf, size_t len);
 extern uint64_t util_CRC64Rev(const uint8_t* buf, size_t len);
+extern uint32_t util_CRC32(uint32_t crc, const uint8_t* buf, size_t len);
 
 #endif /* ifndef _HF_COMMON_UTIL_H_ */
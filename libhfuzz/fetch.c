@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -14,6 +15,8 @@
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
+#include "libhfcommon/mutate.h"
+#include "libhfcommon/util.h"
 
 /*
  * If this signature is visible inside a binary, it's probably a persistent-style fuzzing program.
@@ -22,21 +25,146 @@
 __attribute__((visibility("default"))) __attribute__((used)) const char* LIBHFUZZ_module_fetch =
     _HF_PERSISTENT_SIG;
 
-static const uint8_t* inputFile = NULL;
+typedef struct {
+    uint8_t* data;
+    size_t mapSz;
+    bool writable;
+} fetchInput_t;
+
+/*
+ * Kept in a shared mapping, so the snapshot mode (which restores private memory only) doesn't roll
+ * it back, e.g. to stale addresses after an input mapping was moved
+ */
+typedef struct {
+    /* inputs[0] is the main input buffer, inputs[1] is filled in while we're busy with the first */
+    fetchInput_t inputs[2];
+    /* The previous input was stopped by the watchdog, see HonggfuzzPersistentLoop() */
+    bool timedOut;
+} fetchShared_t;
+
+static fetchShared_t* fetchShared = NULL;
+/* The current input is to be mutated by the fuzzed process, see HonggfuzzPersistentLoop() */
+static fetchInput_t* fetchMutateInput = NULL;
+/* The corpus shared by honggfuzz, and the buffer of inputs created from it (--persistent_mangle) */
+static const uint8_t* fetchCorpus = NULL;
+static uint8_t* fetchMangleBuf = NULL;
+static size_t fetchMangleBufSz = 0;
+
+extern feedback_t* covFeedback;
+extern uint32_t my_thread_no;
+
+static size_t fetchGetMapSize(void) {
+    const char* maxSzStr = getenv(_HF_INPUT_MAX_SIZE_ENV);
+    if (!maxSzStr) {
+        return _HF_INPUT_DEFAULT_SIZE;
+    }
+    size_t maxSz = strtoull(maxSzStr, NULL, 0);
+    if (maxSz == 0 || maxSz > _HF_INPUT_MAX_SIZE) {
+        LOG_W("Incorrect value of %s: '%s'", _HF_INPUT_MAX_SIZE_ENV, maxSzStr);
+        return _HF_INPUT_DEFAULT_SIZE;
+    }
+    return maxSz;
+}
+
+static void fetchMapInput(fetchInput_t* input, int fd, size_t sz) {
+    void* ret = mmap(NULL, sz, PROT_READ, MAP_SHARED, fd, 0);
+    if (ret == MAP_FAILED) {
+        PLOG_F("mmap(fd=%d, size=%zu) of the input file failed", fd, sz);
+    }
+    input->data = ret;
+    input->mapSz = sz;
+    input->writable = false;
+}
+
+/* The mapping is extended only if the fuzzer sends an input bigger than the negotiated size */
+static void fetchGrowInput(fetchInput_t* input, int fd, size_t len) {
+    if (len <= input->mapSz) {
+        return;
+    }
+    size_t newSz = HF_MIN(HF_MAX(len, input->mapSz * 2), (size_t)_HF_INPUT_MAX_SIZE);
+#if defined(_HF_ARCH_LINUX)
+    void* ret = mremap((void*)input->data, input->mapSz, newSz, MREMAP_MAYMOVE);
+    if (ret == MAP_FAILED) {
+        PLOG_F("mremap(fd=%d, %zu -> %zu) of the input file failed", fd, input->mapSz, newSz);
+    }
+    input->data = ret;
+    input->mapSz = newSz;
+#else  /* defined(_HF_ARCH_LINUX) */
+    if (munmap((void*)input->data, input->mapSz) == -1) {
+        PLOG_W("munmap(%p, %zu)", input->data, input->mapSz);
+    }
+    fetchMapInput(input, fd, newSz);
+#endif /* defined(_HF_ARCH_LINUX) */
+}
+
+/*
+ * Both mappings are shared ones, which the snapshot (--linux_snapshot) doesn't capture, so pages of
+ * the mangling buffer are not copied back after each input
+ */
+static void fetchMapCorpus(size_t maxSz) {
+    void* ret = mmap(NULL, _HF_CORPUS_MAP_SIZE, PROT_READ, MAP_SHARED, _HF_CORPUS_FD, 0);
+    if (ret == MAP_FAILED) {
+        PLOG_F("mmap(fd=%d, size=%zu) of the corpus failed", _HF_CORPUS_FD,
+            (size_t)_HF_CORPUS_MAP_SIZE);
+    }
+    fetchCorpus = ret;
+    if ((ret = mmap(NULL, maxSz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0)) ==
+        MAP_FAILED) {
+        PLOG_F("mmap(size=%zu)", maxSz);
+    }
+    fetchMangleBuf = ret;
+    fetchMangleBufSz = maxSz;
+}
+
+/* Creates the input from a corpus seed, in the same way as honggfuzz will if it's interesting */
+static size_t fetchMangle(size_t seedSz, const uint8_t** buf_ptr) {
+    if (!fetchCorpus) {
+        LOG_F("Received a corpus seed, but the corpus (fd=%d) is not mapped", _HF_CORPUS_FD);
+    }
+    uint64_t off = ATOMIC_GET(covFeedback->childMut[my_thread_no].corpusOff);
+    size_t maxSz = (size_t)ATOMIC_GET(covFeedback->childMut[my_thread_no].maxSize);
+    if (off > _HF_CORPUS_MAP_SIZE || seedSz > (_HF_CORPUS_MAP_SIZE - off) ||
+        maxSz > fetchMangleBufSz || seedSz > maxSz) {
+        LOG_F("Invalid corpus seed: off:%" PRIu64 ", size:%zu, max size:%zu (buffer size:%zu)", off,
+            seedSz, maxSz, fetchMangleBufSz);
+    }
+
+    memcpy(fetchMangleBuf, &fetchCorpus[off], seedSz);
+    size_t len = mutate_Buf(fetchMangleBuf, seedSz, maxSz,
+        ATOMIC_GET(covFeedback->childMut[my_thread_no].seed),
+        ATOMIC_GET(covFeedback->childMut[my_thread_no].changesCnt),
+        ATOMIC_GET(covFeedback->childMut[my_thread_no].printable));
+    ATOMIC_SET(covFeedback->childMut[my_thread_no].size, len);
+
+    *buf_ptr = fetchMangleBuf;
+    return len;
+}
+
 __attribute__((constructor)) static void init(void) {
     if (fcntl(_HF_INPUT_FD, F_GETFD) == -1 && errno == EBADF) {
         return;
     }
-    if ((inputFile = mmap(NULL, _HF_INPUT_MAX_SIZE, PROT_READ, MAP_SHARED, _HF_INPUT_FD, 0)) ==
-        MAP_FAILED) {
-        PLOG_F("mmap(fd=%d, size=%zu) of the input file failed", _HF_INPUT_FD,
-            (size_t)_HF_INPUT_MAX_SIZE);
+    if ((fetchShared = mmap(NULL, sizeof(fetchShared_t), PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED) {
+        PLOG_F("mmap(size=%zu)", sizeof(fetchShared_t));
     }
+
+    size_t mapSz = fetchGetMapSize();
+    fetchMapInput(&fetchShared->inputs[0], _HF_INPUT_FD, mapSz);
+    if (fcntl(_HF_CORPUS_FD, F_GETFD) != -1) {
+        fetchMapCorpus(mapSz);
+    }
+    if (fcntl(_HF_INPUT_ALT_FD, F_GETFD) == -1 && errno == EBADF) {
+        return;
+    }
+    fetchMapInput(&fetchShared->inputs[1], _HF_INPUT_ALT_FD, mapSz);
 }
 
 void HonggfuzzFetchData(const uint8_t** buf_ptr, size_t* len_ptr) {
-    if (!files_writeToFd(_HF_PERSISTENT_FD, &HFReadyTag, sizeof(HFReadyTag))) {
-        LOG_F("writeToFd(size=%zu, readyTag) failed", sizeof(HFReadyTag));
+    const uint8_t* tag = fetchShared->timedOut ? &HFTimeoutTag : &HFReadyTag;
+    fetchShared->timedOut = false;
+    if (!files_writeToFd(_HF_PERSISTENT_FD, tag, sizeof(*tag))) {
+        LOG_F("writeToFd(size=%zu, readyTag) failed", sizeof(*tag));
     }
 
     uint64_t rcvLen;
@@ -49,15 +177,71 @@ void HonggfuzzFetchData(const uint8_t** buf_ptr, size_t* len_ptr) {
             sizeof(rcvLen), sz);
     }
 
-    *buf_ptr = inputFile;
+    int fd = _HF_INPUT_FD;
+    fetchInput_t* input = &fetchShared->inputs[0];
+    if (rcvLen & _HF_INPUT_ALT_FLAG) {
+        if (fetchShared->inputs[1].data == NULL) {
+            LOG_F("Received input in the alternate buffer, but fd=%d is not mapped",
+                _HF_INPUT_ALT_FD);
+        }
+        fd = _HF_INPUT_ALT_FD;
+        input = &fetchShared->inputs[1];
+        rcvLen &= ~(_HF_INPUT_ALT_FLAG);
+    }
+    fetchMutateInput = NULL;
+    if (rcvLen & _HF_INPUT_MANGLE_FLAG) {
+        *len_ptr = fetchMangle((size_t)(rcvLen & ~(_HF_INPUT_MANGLE_FLAG)), buf_ptr);
+        return;
+    }
+    if (rcvLen & _HF_INPUT_MUTATE_FLAG) {
+        fetchMutateInput = input;
+        rcvLen &= ~(_HF_INPUT_MUTATE_FLAG);
+    }
+    if (rcvLen > _HF_INPUT_MAX_SIZE) {
+        LOG_F("Received input size (%" PRIu64 ") > _HF_INPUT_MAX_SIZE (%zu)", rcvLen,
+            (size_t)_HF_INPUT_MAX_SIZE);
+    }
+    fetchGrowInput(input, fd, (size_t)rcvLen);
+    *buf_ptr = input->data;
     *len_ptr = (size_t)rcvLen;
 
-    if (lseek(_HF_INPUT_FD, (off_t)0, SEEK_SET) == -1) {
-        PLOG_W("lseek(_HF_INPUT_FD=%d, 0)", _HF_INPUT_FD);
+    if (lseek(fd, (off_t)0, SEEK_SET) == -1) {
+        PLOG_W("lseek(fd=%d, 0)", fd);
     }
 }
 
+/*
+ * Returns the writable buffer of the current input (of *maxSz bytes), if honggfuzz asked the
+ * fuzzed process to mutate it
+ */
+uint8_t* fetchGetMutableInput(size_t* maxSz) {
+    if (!fetchMutateInput) {
+        return NULL;
+    }
+    /* Inputs are read-only otherwise, so targets overwriting them crash */
+    if (!fetchMutateInput->writable) {
+        if (mprotect(fetchMutateInput->data, fetchMutateInput->mapSz, PROT_READ | PROT_WRITE) ==
+            -1) {
+            PLOG_W("mprotect(%p, %zu, PROT_READ|PROT_WRITE)", fetchMutateInput->data,
+                fetchMutateInput->mapSz);
+            return NULL;
+        }
+        fetchMutateInput->writable = true;
+    }
+    *maxSz = fetchMutateInput->mapSz;
+    return fetchMutateInput->data;
+}
+
+/* Max input size negotiated with honggfuzz (bigger inputs, if sent, grow the mapping) */
+size_t fetchGetInputMaxSize(void) {
+    return fetchGetMapSize();
+}
+
+void fetchReportTimeout(void) {
+    fetchShared->timedOut = true;
+}
+
 bool fetchIsInputAvailable(void) {
     LOG_D("Current module: %s", LIBHFUZZ_module_fetch);
-    return (inputFile != NULL);
+    return (fetchShared != NULL);
 }
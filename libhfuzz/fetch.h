@@ -31,5 +31,8 @@
 
 extern void HonggfuzzFetchData(const uint8_t** buf_ptr, size_t* len_ptr);
 extern bool fetchIsInputAvailable(void);
+extern void fetchReportTimeout(void);
+extern uint8_t* fetchGetMutableInput(size_t* maxSz);
+extern size_t fetchGetInputMaxSize(void);
 
 #endif /* ifdef _HF_LIBHFUZZ_FETCH_H_ */
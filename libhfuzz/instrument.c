@@ -211,10 +211,70 @@ static inline void instrumentAddConstMemInternal(const void* mem, size_t len) {
     wmb();
 }
 
+/*
+ * Operands of a passed validation check (e.g. of a length or a checksum) are equal, and the fuzzer
+ * looks them up in the input to find fields to keep consistent after mutations
+ */
+static inline void instrumentAddCmpEq(uint32_t val) {
+    if (!covFeedback->cmpEqLog || val < 4) {
+        return;
+    }
+    uint32_t cnt = ATOMIC_GET(covFeedback->cmpEq[my_thread_no].cnt);
+    if (cnt >= _HF_CMP_EQ_MAX) {
+        return;
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        if (covFeedback->cmpEq[my_thread_no].val[i] == val) {
+            return;
+        }
+    }
+    covFeedback->cmpEq[my_thread_no].val[cnt] = val;
+    ATOMIC_SET(covFeedback->cmpEq[my_thread_no].cnt, cnt + 1);
+}
+
+/*
+ * Calling context of the current thread: XOR of hashes of functions on its call stack (returning
+ * from a function removes its hash). Used by --context_cov to count edges per calling context
+ */
+__attribute__((tls_model("initial-exec"))) static __thread uint32_t instrumentCtx = 0;
+/* Sized to the number of PC-guards, so that context features don't evict edges from the cache */
+static uint32_t instrumentCtxMask = (_HF_CTX_MAP_SIZE * 8U) - 1U;
+
+static inline uint32_t instrumentCtxHash(void* func) {
+    return (uint32_t)(((uint64_t)(uintptr_t)func * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static void instrumentCtxResize(uint64_t guardNb) {
+    uint64_t sz = 1;
+    while (sz < guardNb) {
+        sz <<= 1;
+    }
+    instrumentCtxMask = (uint32_t)HF_MIN(sz * _HF_CTX_PER_EDGE, _HF_CTX_MAP_SIZE * 8ULL) - 1U;
+}
+
+void instrumentCtxReset(void) {
+    instrumentCtx = 0;
+}
+
+HF_REQUIRE_SSE42_POPCNT static inline void instrumentAddCtxEdge(uintptr_t loc) {
+    /* Context 0 is the top level (or balanced recursion), covered by plain edges already */
+    if (!instrumentCtx || !covFeedback->ctxCovLog) {
+        return;
+    }
+    register size_t pos = (loc ^ instrumentCtx) & instrumentCtxMask;
+    register bool prev = ATOMIC_BITMAP_SET(covFeedback->ctxMap, pos);
+    if (!prev) {
+        ATOMIC_PRE_INC_RELAXED(covFeedback->pidFeedbackEdge[my_thread_no]);
+        wmb();
+    }
+}
+
 /*
  * -finstrument-functions
  */
 HF_REQUIRE_SSE42_POPCNT void __cyg_profile_func_enter(void* func, void* caller) {
+    instrumentCtx ^= instrumentCtxHash(func);
+
     register size_t pos =
         (((uintptr_t)func << 12) | ((uintptr_t)caller & 0xFFF)) & _HF_PERF_BITMAP_BITSZ_MASK;
     register bool prev = ATOMIC_BITMAP_SET(covFeedback->bbMapPc, pos);
@@ -224,15 +284,33 @@ HF_REQUIRE_SSE42_POPCNT void __cyg_profile_func_enter(void* func, void* caller)
     }
 }
 
-HF_REQUIRE_SSE42_POPCNT void __cyg_profile_func_exit(
-    void* func HF_ATTR_UNUSED, void* caller HF_ATTR_UNUSED) {
-    return;
+HF_REQUIRE_SSE42_POPCNT void __cyg_profile_func_exit(void* func, void* caller HF_ATTR_UNUSED) {
+    instrumentCtx ^= instrumentCtxHash(func);
 }
 
 /*
  * -fsanitize-coverage=trace-pc
  */
+/*
+ * Adds 1/8 of code locations (so the sketch doesn't saturate too quickly) to the coverage sketch of
+ * the current input, which the fuzzer uses to find similar inputs to splice with
+ */
+static inline void instrumentAddCovSig(uint64_t loc) {
+    const uint64_t h = loc * 0x9E3779B97F4A7C15ULL;
+    if ((h >> 61) != 0 || !covFeedback->covSigLog) {
+        return;
+    }
+    const size_t word = (h >> 58) % _HF_COV_SIG_WORDS;
+    const uint64_t bit = 1ULL << ((h >> 52) & 0x3F);
+    if (!(ATOMIC_GET(covFeedback->covSig[my_thread_no][word]) & bit)) {
+        ATOMIC_POST_OR(covFeedback->covSig[my_thread_no][word], bit);
+    }
+}
+
 HF_REQUIRE_SSE42_POPCNT static inline void hfuzz_trace_pc_internal(uintptr_t pc) {
+    instrumentAddCovSig(pc);
+    instrumentAddCtxEdge(pc);
+
     register uintptr_t ret = pc & _HF_PERF_BITMAP_BITSZ_MASK;
 
     register bool prev = ATOMIC_BITMAP_SET(covFeedback->bbMapPc, ret);
@@ -307,10 +385,16 @@ void __sanitizer_cov_trace_cmp1(uint8_t Arg1, uint8_t Arg2) {
 }
 
 void __sanitizer_cov_trace_cmp2(uint16_t Arg1, uint16_t Arg2) {
+    if (Arg1 == Arg2) {
+        instrumentAddCmpEq(Arg1);
+    }
     hfuzz_trace_cmp2_internal((uintptr_t)__builtin_return_address(0), Arg1, Arg2);
 }
 
 void __sanitizer_cov_trace_cmp4(uint32_t Arg1, uint32_t Arg2) {
+    if (Arg1 == Arg2) {
+        instrumentAddCmpEq(Arg1);
+    }
     /* Add 4byte values to the const_dictionary if they exist within the binary */
     if (cmpFeedback && instrumentLimitEvery(4095)) {
         if (Arg1 > 0xffff && Arg1 < 0xffff0000) {
@@ -333,6 +417,9 @@ void __sanitizer_cov_trace_cmp4(uint32_t Arg1, uint32_t Arg2) {
 }
 
 void __sanitizer_cov_trace_cmp8(uint64_t Arg1, uint64_t Arg2) {
+    if (Arg1 == Arg2 && Arg1 <= UINT32_MAX) {
+        instrumentAddCmpEq((uint32_t)Arg1);
+    }
     /* Add 8byte values to the const_dictionary if they exist within the binary */
     if (cmpFeedback && instrumentLimitEvery(4095)) {
         if (Arg1 > 0xffff && Arg1 < 0xffffffffffff0000) {
@@ -535,10 +622,16 @@ HF_REQUIRE_SSE42_POPCNT void __sanitizer_cov_trace_pc_guard_init(uint32_t* start
 
     for (uint32_t* x = start; x < stop; x++) {
         uint32_t guardNo = instrumentReserveGuard(1);
-        /* If the corresponding PC was already hit, map this specific guard as uninteresting (0) */
-        *x = ATOMIC_GET(covFeedback->pcGuardMap[guardNo]) ? 0U : guardNo;
+        /*
+         * If the corresponding PC was already hit, map this specific guard as uninteresting (0),
+         * unless it can still be reached in new calling contexts, or it's a part of the coverage
+         * signatures of inputs
+         */
+        bool hit = ATOMIC_GET(covFeedback->pcGuardMap[guardNo]);
+        *x = (hit && !covFeedback->ctxCovLog && !covFeedback->covSigLog) ? 0U : guardNo;
         wmb();
     }
+    instrumentCtxResize(ATOMIC_GET(covFeedback->guardNb));
 }
 
 HF_REQUIRE_SSE42_POPCNT void __sanitizer_cov_trace_pc_guard(uint32_t* guard) {
@@ -570,6 +663,9 @@ HF_REQUIRE_SSE42_POPCNT void __sanitizer_cov_trace_pc_guard(uint32_t* guard) {
         return;
     }
 #endif /* defined(__ANDROID__) */
+    instrumentAddCovSig(*guard);
+    instrumentAddCtxEdge(*guard);
+
     if (!ATOMIC_GET(covFeedback->pcGuardMap[*guard])) {
         bool prev = ATOMIC_XCHG(covFeedback->pcGuardMap[*guard], true);
         if (prev == false) {
@@ -611,6 +707,8 @@ void instrument8BitCountersCount(void) {
             const uint8_t new = scaleMap[v];
             const size_t guard = hf8bitcounters[i].guard + j;
 
+            instrumentAddCovSig(guard);
+
             if (ATOMIC_GET(covFeedback->pcGuardMap[guard]) < new) {
                 const uint8_t prev = ATOMIC_POST_OR(covFeedback->pcGuardMap[guard], new);
                 if (!prev) {
@@ -655,10 +753,43 @@ void __sanitizer_cov_pcs_init(
     const uintptr_t* pcs_beg HF_ATTR_UNUSED, const uintptr_t* pcs_end HF_ATTR_UNUSED) {
 }
 
-/* For some reason -fsanitize=fuzzer-no-link references this symbol */
+/*
+ * -fsanitize-coverage=stack-depth: functions store the stack pointer here, if it's lower than the
+ * current value. It's also referenced by -fsanitize=fuzzer-no-link
+ */
 __attribute__((tls_model("initial-exec")))
 __attribute__((weak)) __thread uintptr_t __sancov_lowest_stack = 0;
 
+static __thread uintptr_t instrumentStackTop = 0;
+
+void instrumentStackDepthClear(uintptr_t top) {
+    instrumentStackTop = top;
+    __sancov_lowest_stack = top;
+}
+
+/* Log-linear buckets (4 per power of 2), so each new max depth is at least ~1/8 deeper */
+static inline uint32_t instrumentStackDepthBucket(uint64_t depth) {
+    if (depth < 4) {
+        return (uint32_t)depth;
+    }
+    unsigned lg = 63 - __builtin_clzll(depth);
+    return (lg * 4) + ((depth >> (lg - 2)) & 0x3);
+}
+
+void instrumentStackDepthCount(void) {
+    if (__sancov_lowest_stack >= instrumentStackTop) {
+        return;
+    }
+    uint32_t v = instrumentStackDepthBucket(instrumentStackTop - __sancov_lowest_stack);
+    /* Only the process which raises the shared maximum gets credited for it */
+    for (uint32_t prev = ATOMIC_GET(covFeedback->stackDepthMax); prev < v;) {
+        if (ATOMIC_CAS(covFeedback->stackDepthMax, prev, v)) {
+            ATOMIC_POST_ADD(covFeedback->pidFeedbackCmp[my_thread_no], v - prev);
+            return;
+        }
+    }
+}
+
 bool instrumentUpdateCmpMap(uintptr_t addr, uint32_t v) {
     uintptr_t pos = addr % _HF_PERF_BITMAP_SIZE_16M;
     uint32_t prev = ATOMIC_GET(covFeedback->bbMapCmp[pos]);
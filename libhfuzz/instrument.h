@@ -33,6 +33,9 @@ void instrument8BitCountersCount(void);
 void instrument8BitCountersClear(void);
 bool instrumentUpdateCmpMap(uintptr_t addr, uint32_t v);
 void instrumentClearNewCov();
+void instrumentCtxReset(void);
+void instrumentStackDepthClear(uintptr_t top);
+void instrumentStackDepthCount(void);
 void instrumentAddConstMem(const void* m, size_t len, bool check_if_ro);
 void instrumentAddConstStr(const char* s);
 void instrumentAddConstStrN(const char* s, size_t n);
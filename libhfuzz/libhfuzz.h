@@ -31,6 +31,26 @@ int LLVMFuzzerInitialize(int* argc, char*** argv);
  */
 size_t LLVMFuzzerMutate(uint8_t* Data, size_t Size, size_t MaxSize);
 
+/*
+ * Optional, persistent mode only: replaces honggfuzz's own mutations of the input
+ *
+ * Data: input to mutate in-place
+ * Size: size of the input
+ * MaxSize: maximum size of the mutated input
+ * Seed: seed for the target's own PRNG
+ *
+ * Return value: size of the mutated input
+ */
+size_t LLVMFuzzerCustomMutator(uint8_t* Data, size_t Size, size_t MaxSize, unsigned int Seed);
+
+/*
+ * Optional, persistent mode only: combines two inputs into 'Out'
+ *
+ * Return value: size of the new input stored in 'Out'
+ */
+size_t LLVMFuzzerCustomCrossOver(const uint8_t* Data1, size_t Size1, const uint8_t* Data2,
+    size_t Size2, uint8_t* Out, size_t MaxOutSize, unsigned int Seed);
+
 /*
  *
  * An alternative for LLVMFuzzerTestOneInput()
@@ -2,6 +2,8 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
+#include <setjmp.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -10,6 +12,7 @@
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -17,19 +20,32 @@
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
+#include "libhfcommon/mutate.h"
+#include "libhfcommon/util.h"
 #include "libhfuzz/fetch.h"
 #include "libhfuzz/instrument.h"
 #include "libhfuzz/libhfuzz.h"
+#include "libhfuzz/snapshot.h"
 
 __attribute__((weak)) int LLVMFuzzerInitialize(
     int* argc HF_ATTR_UNUSED, char*** argv HF_ATTR_UNUSED) {
     return 1;
 }
 
-__attribute__((weak)) size_t LLVMFuzzerMutate(
-    uint8_t* Data HF_ATTR_UNUSED, size_t Size HF_ATTR_UNUSED, size_t MaxSize HF_ATTR_UNUSED) {
-    LOG_F("LLVMFuzzerMutate() is not supported in honggfuzz yet");
-    return 0;
+/* Optional, libFuzzer-compatible custom mutators: NULL, unless defined by the fuzzed code */
+__attribute__((weak)) size_t LLVMFuzzerCustomMutator(
+    uint8_t* Data, size_t Size, size_t MaxSize, unsigned int Seed);
+__attribute__((weak)) size_t LLVMFuzzerCustomCrossOver(const uint8_t* Data1, size_t Size1,
+    const uint8_t* Data2, size_t Size2, uint8_t* Out, size_t MaxOutSize, unsigned int Seed);
+
+/* Seed of LLVMFuzzerMutate(), different for each call, but reproducible for the same input */
+static uint64_t mutateSeed = 0;
+
+/* Byte-level mutations, for custom mutators which fall back to the default one */
+__attribute__((weak)) size_t LLVMFuzzerMutate(uint8_t* Data, size_t Size, size_t MaxSize) {
+    uint64_t seed = mutateSeed++;
+    return mutate_Buf(Data, Size, MaxSize, seed, /* changesCnt= */ (unsigned)(seed % 4) + 1,
+        /* printable= */ false);
 }
 
 __attribute__((weak)) int LLVMFuzzerTestOneInput(
@@ -39,42 +55,161 @@ __attribute__((weak)) int LLVMFuzzerTestOneInput(
     return 0;
 }
 
-static const uint8_t* inputFile = NULL;
-__attribute__((constructor)) static void initializePersistent(void) {
-    if (fcntl(_HF_INPUT_FD, F_GETFD) == -1 && errno == EBADF) {
+void HF_ITER(const uint8_t** buf_ptr, size_t* len_ptr) {
+    HonggfuzzFetchData(buf_ptr, len_ptr);
+}
+
+/*
+ * The in-process watchdog (--persistent_watchdog): SIGALRM jumps out of LLVMFuzzerTestOneInput()
+ * running for too long, back to the persistent loop. Whatever the input was doing is abandoned
+ * (e.g. held locks or allocated memory), so if that makes the next inputs hang, the parent kills
+ * the process as usual
+ */
+static uint64_t watchdogMSec = 0;
+static pthread_t watchdogThread;
+static sigjmp_buf watchdogJmpBuf;
+static volatile sig_atomic_t watchdogArmed = 0;
+
+static void watchdogHandler(int sig HF_ATTR_UNUSED) {
+    if (!watchdogArmed) {
+        return;
+    }
+    /* It's a process-wide signal, and only the fuzzing thread can jump back to its loop */
+    if (!pthread_equal(pthread_self(), watchdogThread)) {
+        pthread_kill(watchdogThread, SIGALRM);
+        return;
+    }
+    watchdogArmed = 0;
+    siglongjmp(watchdogJmpBuf, 1);
+}
+
+static void watchdogSet(uint64_t msec) {
+    const struct itimerval it = {
+        .it_interval = {.tv_sec = 0, .tv_usec = 0},
+        .it_value = {.tv_sec = msec / 1000, .tv_usec = (msec % 1000) * 1000},
+    };
+    if (setitimer(ITIMER_REAL, &it, NULL) == -1) {
+        PLOG_W("setitimer(ITIMER_REAL, %" PRIu64 " ms)", msec);
+    }
+}
+
+static void watchdogInit(void) {
+    const char* msecStr = getenv(_HF_WATCHDOG_ENV);
+    if (!msecStr || !(watchdogMSec = strtoull(msecStr, NULL, 0))) {
         return;
     }
-    int mflags = files_getTmpMapFlags(MAP_SHARED, /* nocore= */ false);
-    if ((inputFile = mmap(NULL, _HF_INPUT_MAX_SIZE, PROT_READ, mflags, _HF_INPUT_FD, 0)) ==
-        MAP_FAILED) {
-        PLOG_F("mmap(fd=%d, size=%zu) of the input file failed", _HF_INPUT_FD,
-            (size_t)_HF_INPUT_MAX_SIZE);
+    watchdogThread = pthread_self();
+    struct sigaction sa = {
+        .sa_handler = watchdogHandler,
+        .sa_flags = SA_RESTART,
+    };
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGALRM, &sa, NULL) == -1) {
+        PLOG_W("sigaction(SIGALRM), the in-process watchdog will not be used");
+        watchdogMSec = 0;
     }
 }
 
-void HF_ITER(const uint8_t** buf_ptr, size_t* len_ptr) {
-    HonggfuzzFetchData(buf_ptr, len_ptr);
+extern feedback_t* covFeedback;
+extern uint32_t my_thread_no;
+
+/*
+ * Output of LLVMFuzzerCustomCrossOver(). Allocated before the snapshot is taken (--linux_snapshot),
+ * so restoring it doesn't drop the pointer to it
+ */
+static uint8_t* crossOverBuf = NULL;
+static size_t crossOverBufSz = 0;
+
+static void customMutatorInit(void) {
+    if (LLVMFuzzerCustomMutator) {
+        LOG_I("LLVMFuzzerCustomMutator() found, inputs will be mutated with it");
+        ATOMIC_SET(covFeedback->customMutator, true);
+    }
+    if (LLVMFuzzerCustomCrossOver) {
+        LOG_I("LLVMFuzzerCustomCrossOver() found, inputs will be crossed over with it");
+        ATOMIC_SET(covFeedback->customCrossOver, true);
+        crossOverBufSz = fetchGetInputMaxSize();
+        crossOverBuf = (uint8_t*)util_Malloc(crossOverBufSz);
+    }
+}
+
+/*
+ * Mutates the input in place (in the input file shared with honggfuzz), if asked to. The resulting
+ * size is passed back through the feedback map, so honggfuzz can save the input if it's interesting
+ */
+static size_t customMutatorRun(const uint8_t* buf, size_t len) {
+    size_t maxSz;
+    uint8_t* data = fetchGetMutableInput(&maxSz);
+    if (!data || data != buf) {
+        return len;
+    }
+
+    uint64_t crossOverLen = ATOMIC_GET(covFeedback->childMut[my_thread_no].crossOverLen);
+    unsigned int seed = (unsigned int)ATOMIC_GET(covFeedback->childMut[my_thread_no].seed);
+    mutateSeed = seed;
+    if (crossOverLen && crossOverBuf && (len + crossOverLen) <= maxSz) {
+        /* The input mapping could have grown since, but the output buffer doesn't */
+        size_t outSz = HF_MIN(maxSz, crossOverBufSz);
+        len = LLVMFuzzerCustomCrossOver(
+            data, len, &data[len], (size_t)crossOverLen, crossOverBuf, outSz, seed);
+        len = HF_MIN(len, outSz);
+        memcpy(data, crossOverBuf, len);
+    } else if (LLVMFuzzerCustomMutator) {
+        len = HF_MIN(LLVMFuzzerCustomMutator(data, len, maxSz, seed), maxSz);
+    }
+    ATOMIC_SET(covFeedback->childMut[my_thread_no].size, len);
+    return len;
 }
 
 extern const char* const LIBHFUZZ_module_memorycmp;
 extern const char* const LIBHFUZZ_module_instrument;
-static void HonggfuzzRunOneInput(const uint8_t* buf, size_t len) {
+/* Returns false if the input was stopped by the watchdog */
+static bool HonggfuzzRunOneInput(const uint8_t* buf, size_t len) {
     instrument8BitCountersClear();
+    /* A longjmp() out of instrumented functions (e.g. by the watchdog) leaves a stale context */
+    instrumentCtxReset();
+    instrumentStackDepthClear((uintptr_t)__builtin_frame_address(0));
+    if (watchdogMSec) {
+        if (sigsetjmp(watchdogJmpBuf, /* savesigs= */ 1) != 0) {
+            instrument8BitCountersCount();
+            return false;
+        }
+        watchdogSet(watchdogMSec);
+        watchdogArmed = 1;
+    }
     int ret = LLVMFuzzerTestOneInput(buf, len);
+    if (watchdogMSec) {
+        watchdogArmed = 0;
+        watchdogSet(0);
+    }
     if (ret != 0) {
         LOG_D("Dereferenced: %s, %s", LIBHFUZZ_module_memorycmp, LIBHFUZZ_module_instrument);
         LOG_F("LLVMFuzzerTestOneInput() returned '%d' instead of '0'", ret);
     }
     instrument8BitCountersCount();
+    instrumentStackDepthCount();
+    return true;
 }
 
 static void HonggfuzzPersistentLoop(void) {
+    /* Set up before the snapshot is taken, so restoring it doesn't reset their state */
+    watchdogInit();
+    customMutatorInit();
+    /* Roll the process memory back to its post-initialization state after each input */
+    bool useSnapshot = snapshotIsRequested() && snapshotTake();
+
     for (;;) {
         size_t len;
         const uint8_t* buf;
 
         HonggfuzzFetchData(&buf, &len);
-        HonggfuzzRunOneInput(buf, len);
+        len = customMutatorRun(buf, len);
+        if (!HonggfuzzRunOneInput(buf, len)) {
+            fetchReportTimeout();
+        }
+        if (useSnapshot) {
+            snapshotRestore();
+        }
     }
 }
 
@@ -93,12 +228,27 @@ static int HonggfuzzRunFromFile(int argc, char** argv) {
     LOG_I("Accepting input from '%s'", fname);
     LOG_I("Usage for fuzzing: honggfuzz -P [flags] -- %s", argv[0]);
 
-    uint8_t* buf = (uint8_t*)util_Malloc(_HF_INPUT_MAX_SIZE);
-    ssize_t len = files_readFromFd(in_fd, buf, _HF_INPUT_MAX_SIZE);
-    if (len < 0) {
-        LOG_E("Couldn't read data from stdin: %s", strerror(errno));
-        free(buf);
-        return -1;
+    /* Grow the buffer as needed, so big inputs don't need a big allocation upfront */
+    size_t bufSz = _HF_INPUT_DEFAULT_SIZE;
+    uint8_t* buf = (uint8_t*)util_Malloc(bufSz);
+    size_t len = 0;
+    for (;;) {
+        ssize_t sz = files_readFromFd(in_fd, &buf[len], bufSz - len);
+        if (sz < 0) {
+            LOG_E("Couldn't read data from stdin: %s", strerror(errno));
+            free(buf);
+            return -1;
+        }
+        len += (size_t)sz;
+        if (len < bufSz) {
+            break;
+        }
+        if (bufSz >= _HF_INPUT_MAX_SIZE) {
+            LOG_W("Input truncated to %zu bytes (_HF_INPUT_MAX_SIZE)", len);
+            break;
+        }
+        bufSz = HF_MIN(bufSz * 2, (size_t)_HF_INPUT_MAX_SIZE);
+        buf = (uint8_t*)util_Realloc(buf, bufSz);
     }
 
     HonggfuzzRunOneInput(buf, len);
@@ -0,0 +1,362 @@
+/*
+ *
+ * honggfuzz - restoring process memory after each persistent-mode iteration
+ * -----------------------------------------
+ *
+ * Copyright 2020 by Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+ * implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ */
+
+/*
+ * The snapshot mode lets targets which are not reentrant run in the persistent mode: all private
+ * writable memory of the process is copied once the target is initialized, and after every input
+ * the pages written to (soft-dirty ones, see Documentation/admin-guide/mm/soft-dirty.rst) are
+ * copied back. It's meant for single-threaded targets: memory mapped after the snapshot, file
+ * descriptors, and other kernel-side state are not rolled back.
+ */
+
+#include "libhfuzz/snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "honggfuzz.h"
+#include "libhfcommon/common.h"
+#include "libhfcommon/files.h"
+#include "libhfcommon/log.h"
+#include "libhfcommon/util.h"
+
+bool snapshotIsRequested(void) {
+    return (getenv(_HF_SNAPSHOT_ENV) != NULL);
+}
+
+#if defined(_HF_ARCH_LINUX)
+
+/* Bits of /proc/self/pagemap entries */
+#define SNAPSHOT_PM_PRESENT (1ULL << 63)
+#define SNAPSHOT_PM_SWAPPED (1ULL << 62)
+#define SNAPSHOT_PM_SOFT_DIRTY (1ULL << 55)
+
+#define SNAPSHOT_MAX_REGIONS 4096
+#define SNAPSHOT_PAGEMAP_CNT 4096
+#define SNAPSHOT_MAPS_SZ (1024 * 1024)
+
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    bool isAnon;
+    uint8_t* copy;
+    /* One entry per page: set if the page wasn't populated yet when the snapshot was taken */
+    uint8_t* zero;
+} snapshotRegion_t;
+
+/* Lives in its own mapping, which is excluded from the snapshot */
+typedef struct {
+    snapshotRegion_t regions[SNAPSHOT_MAX_REGIONS];
+    size_t regionsCnt;
+    uintptr_t brk;
+    size_t pageSz;
+    int pagemapFd;
+    int clearRefsFd;
+    bool softDirty;
+    uint64_t pagemap[SNAPSHOT_PAGEMAP_CNT];
+    char maps[SNAPSHOT_MAPS_SZ];
+} snapshot_t;
+
+typedef enum {
+    SNAPSHOT_SKIP = 0,
+    SNAPSHOT_COPY,
+    SNAPSHOT_ZERO,
+    SNAPSHOT_REMAP_COPY,
+    SNAPSHOT_REMAP,
+} snapshotAction_t;
+
+static snapshot_t* snapshot = NULL;
+
+static bool snapshotClearSoftDirty(void) {
+    static const char clearSoftDirty[] = "4";
+    if (TEMP_FAILURE_RETRY(write(snapshot->clearRefsFd, clearSoftDirty, 1)) != 1) {
+        PLOG_W("write('/proc/self/clear_refs', '%s')", clearSoftDirty);
+        return false;
+    }
+    return true;
+}
+
+/* Reads pagemap entries for cnt pages starting at addr into snapshot->pagemap */
+static bool snapshotReadPagemap(uintptr_t addr, size_t cnt) {
+    if (snapshot->pagemapFd == -1) {
+        return false;
+    }
+    size_t len = cnt * sizeof(snapshot->pagemap[0]);
+    off_t off = (off_t)((addr / snapshot->pageSz) * sizeof(snapshot->pagemap[0]));
+    return (TEMP_FAILURE_RETRY(pread(snapshot->pagemapFd, snapshot->pagemap, len, off)) ==
+            (ssize_t)len);
+}
+
+static bool snapshotIsExcluded(uintptr_t start, uintptr_t end, const char* perms, const char* name) {
+    /* Only private writable memory can be changed by the process itself */
+    if (perms[1] != 'w' || perms[3] != 'p') {
+        return true;
+    }
+    /* The stack is in use by the restoring code, and the kernel-provided pages are special */
+    if (strncmp(name, "[stack", strlen("[stack")) == 0 || strcmp(name, "[vvar]") == 0 ||
+        strcmp(name, "[vdso]") == 0 || strcmp(name, "[vsyscall]") == 0) {
+        return true;
+    }
+    uintptr_t snapStart = (uintptr_t)snapshot;
+    uintptr_t snapEnd = snapStart + sizeof(snapshot_t);
+    if (start < snapEnd && end > snapStart) {
+        return true;
+    }
+    return false;
+}
+
+static bool snapshotParseMaps(void) {
+    int fd = TEMP_FAILURE_RETRY(open("/proc/self/maps", O_RDONLY | O_CLOEXEC));
+    if (fd == -1) {
+        PLOG_W("open('/proc/self/maps')");
+        return false;
+    }
+    ssize_t sz = files_readFromFd(fd, (uint8_t*)snapshot->maps, sizeof(snapshot->maps) - 1);
+    close(fd);
+    if (sz <= 0 || (size_t)sz == (sizeof(snapshot->maps) - 1)) {
+        LOG_W("Couldn't read '/proc/self/maps', or it's bigger than %zu bytes",
+            sizeof(snapshot->maps) - 1);
+        return false;
+    }
+    snapshot->maps[sz] = '\0';
+
+    for (char* line = snapshot->maps; line && *line;) {
+        char* eol = strchr(line, '\n');
+        if (eol) {
+            *eol = '\0';
+        }
+
+        uintptr_t start, end;
+        char perms[5];
+        int nameOff = 0;
+        if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4s %*x %*x:%*x %*u %n", &start, &end, perms,
+                &nameOff) == 3 &&
+            !snapshotIsExcluded(start, end, perms, &line[nameOff])) {
+            if (snapshot->regionsCnt == SNAPSHOT_MAX_REGIONS) {
+                LOG_W("Too many memory regions to snapshot (max: %d)", SNAPSHOT_MAX_REGIONS);
+                return false;
+            }
+            snapshot->regions[snapshot->regionsCnt].start = start;
+            snapshot->regions[snapshot->regionsCnt].end = end;
+            /* Not backed by a file, so unpopulated pages read as zeros */
+            snapshot->regions[snapshot->regionsCnt].isAnon =
+                (line[nameOff] == '\0' || line[nameOff] == '[');
+            snapshot->regionsCnt++;
+        }
+
+        line = eol ? eol + 1 : NULL;
+    }
+    return true;
+}
+
+/* Kernels without CONFIG_MEM_SOFT_DIRTY don't set the bit, so every page has to be restored */
+static bool snapshotSoftDirtyWorks(void) {
+    if (snapshot->clearRefsFd == -1 || !snapshotClearSoftDirty()) {
+        return false;
+    }
+    /* Dirty a page, and check whether the kernel noticed it */
+    snapshot->pagemap[0] = 0;
+    if (!snapshotReadPagemap((uintptr_t)&snapshot->pagemap[0], 1)) {
+        return false;
+    }
+    return ((snapshot->pagemap[0] & SNAPSHOT_PM_SOFT_DIRTY) != 0);
+}
+
+/* Pages which were never populated are not copied, that keeps the snapshot of big .bss's small */
+static void snapshotCopyRegion(snapshotRegion_t* r) {
+    const size_t pageSz = snapshot->pageSz;
+    for (uintptr_t addr = r->start; addr < r->end;) {
+        size_t cnt = HF_MIN((r->end - addr) / pageSz, (size_t)SNAPSHOT_PAGEMAP_CNT);
+        size_t pageNo = (addr - r->start) / pageSz;
+        if (!r->isAnon || !snapshotReadPagemap(addr, cnt)) {
+            memcpy(&r->copy[addr - r->start], (const void*)addr, cnt * pageSz);
+            addr += cnt * pageSz;
+            continue;
+        }
+        for (size_t i = 0; i < cnt; i++) {
+            if (snapshot->pagemap[i] & (SNAPSHOT_PM_PRESENT | SNAPSHOT_PM_SWAPPED)) {
+                uintptr_t pageAddr = addr + i * pageSz;
+                memcpy(&r->copy[pageAddr - r->start], (const void*)pageAddr, pageSz);
+            } else {
+                r->zero[pageNo + i] = 1;
+            }
+        }
+        addr += cnt * pageSz;
+    }
+}
+
+bool snapshotTake(void) {
+    if ((snapshot = mmap(NULL, sizeof(snapshot_t), PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED) {
+        PLOG_W("mmap(size=%zu)", sizeof(snapshot_t));
+        snapshot = NULL;
+        return false;
+    }
+    snapshot->pageSz = (size_t)sysconf(_SC_PAGESIZE);
+    snapshot->pagemapFd = TEMP_FAILURE_RETRY(open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC));
+    snapshot->clearRefsFd = TEMP_FAILURE_RETRY(open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC));
+
+    if (!snapshotParseMaps()) {
+        munmap(snapshot, sizeof(snapshot_t));
+        snapshot = NULL;
+        return false;
+    }
+
+    size_t totalSz = 0;
+    for (size_t i = 0; i < snapshot->regionsCnt; i++) {
+        totalSz += snapshot->regions[i].end - snapshot->regions[i].start;
+    }
+    size_t totalPages = totalSz / snapshot->pageSz;
+    uint8_t* copy = mmap(NULL, totalSz + totalPages, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (copy == MAP_FAILED) {
+        PLOG_W("mmap(size=%zu)", totalSz + totalPages);
+        munmap(snapshot, sizeof(snapshot_t));
+        snapshot = NULL;
+        return false;
+    }
+    uint8_t* zero = &copy[totalSz];
+    for (size_t i = 0; i < snapshot->regionsCnt; i++) {
+        snapshotRegion_t* r = &snapshot->regions[i];
+        r->copy = copy;
+        r->zero = zero;
+        copy += (r->end - r->start);
+        zero += (r->end - r->start) / snapshot->pageSz;
+        snapshotCopyRegion(r);
+    }
+    snapshot->brk = (uintptr_t)syscall(__NR_brk, 0);
+
+    snapshot->softDirty = snapshotSoftDirtyWorks();
+    if (!snapshot->softDirty) {
+        LOG_W("Soft-dirty page tracking is not available, all populated pages will be restored "
+              "each time");
+    }
+
+    LOG_I("Snapshot taken: %zu memory regions, %zu bytes, soft-dirty tracking: %s",
+        snapshot->regionsCnt, totalSz, snapshot->softDirty ? "true" : "false");
+    return true;
+}
+
+static snapshotAction_t snapshotPageAction(const snapshotRegion_t* r, size_t pageNo, uint64_t e) {
+    bool present = ((e & (SNAPSHOT_PM_PRESENT | SNAPSHOT_PM_SWAPPED)) != 0);
+    if (present && snapshot->softDirty && !(e & SNAPSHOT_PM_SOFT_DIRTY)) {
+        return SNAPSHOT_SKIP;
+    }
+    if (present) {
+        return r->zero[pageNo] ? SNAPSHOT_ZERO : SNAPSHOT_COPY;
+    }
+    return r->zero[pageNo] ? SNAPSHOT_REMAP : SNAPSHOT_REMAP_COPY;
+}
+
+static void snapshotRestorePages(
+    const snapshotRegion_t* r, uintptr_t addr, size_t len, snapshotAction_t action) {
+    if (action == SNAPSHOT_REMAP || action == SNAPSHOT_REMAP_COPY) {
+        /* The memory could have been unmapped in the meantime (e.g. by free()), map it back */
+        unsigned char vec[SNAPSHOT_PAGEMAP_CNT];
+        if (mincore((void*)addr, len, vec) == -1 && errno == ENOMEM &&
+            mmap((void*)addr, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+            PLOG_F("mmap(addr=%p, len=%zu, MAP_FIXED)", (void*)addr, len);
+        }
+        if (action == SNAPSHOT_REMAP) {
+            return;
+        }
+    }
+    if (action == SNAPSHOT_ZERO) {
+        /* Private anonymous memory reads as zeros after that */
+        if (madvise((void*)addr, len, MADV_DONTNEED) == -1) {
+            memset((void*)addr, '\0', len);
+        }
+        return;
+    }
+    memcpy((void*)addr, &r->copy[addr - r->start], len);
+}
+
+static void snapshotRestoreRegion(const snapshotRegion_t* r) {
+    const size_t pageSz = snapshot->pageSz;
+    for (uintptr_t addr = r->start; addr < r->end;) {
+        size_t cnt = HF_MIN((r->end - addr) / pageSz, (size_t)SNAPSHOT_PAGEMAP_CNT);
+        size_t pageNo = (addr - r->start) / pageSz;
+        if (!snapshotReadPagemap(addr, cnt)) {
+            /* The copy of never populated pages consists of zeros */
+            snapshotRestorePages(r, addr, cnt * pageSz, SNAPSHOT_REMAP_COPY);
+            addr += cnt * pageSz;
+            continue;
+        }
+
+        for (size_t i = 0; i < cnt;) {
+            snapshotAction_t action = snapshotPageAction(r, pageNo + i, snapshot->pagemap[i]);
+            if (action == SNAPSHOT_SKIP) {
+                i++;
+                continue;
+            }
+            /* Coalesce neighboring pages which need the same treatment */
+            size_t j = i + 1;
+            while (j < cnt && snapshotPageAction(r, pageNo + j, snapshot->pagemap[j]) == action) {
+                j++;
+            }
+            snapshotRestorePages(r, addr + i * pageSz, (j - i) * pageSz, action);
+            i = j;
+        }
+        addr += cnt * pageSz;
+    }
+}
+
+void snapshotRestore(void) {
+    if (!snapshot) {
+        return;
+    }
+
+    /* Heap memory allocated/released after the snapshot was taken */
+    if ((uintptr_t)syscall(__NR_brk, 0) != snapshot->brk) {
+        syscall(__NR_brk, snapshot->brk);
+    }
+
+    for (size_t i = 0; i < snapshot->regionsCnt; i++) {
+        snapshotRestoreRegion(&snapshot->regions[i]);
+    }
+
+    if (snapshot->softDirty && !snapshotClearSoftDirty()) {
+        LOG_W("Couldn't clear soft-dirty bits, restoring all populated pages from now on");
+        snapshot->softDirty = false;
+    }
+}
+
+#else /* defined(_HF_ARCH_LINUX) */
+
+bool snapshotTake(void) {
+    LOG_W("The snapshot mode is supported under Linux only");
+    return false;
+}
+
+void snapshotRestore(void) {
+}
+
+#endif /* defined(_HF_ARCH_LINUX) */
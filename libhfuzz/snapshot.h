@@ -0,0 +1,31 @@
+/*
+ *
+ * honggfuzz - restoring process memory after each persistent-mode iteration
+ * -----------------------------------------
+ *
+ * Copyright 2020 by Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+ * implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ */
+
+#ifndef _HF_LIBHFUZZ_SNAPSHOT_H_
+#define _HF_LIBHFUZZ_SNAPSHOT_H_
+
+#include <stdbool.h>
+
+extern bool snapshotIsRequested(void);
+extern bool snapshotTake(void);
+extern void snapshotRestore(void);
+
+#endif /* ifdef _HF_LIBHFUZZ_SNAPSHOT_H_ */
@@ -35,8 +35,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
+#include <sys/epoll.h>
 #include <sys/personality.h>
 #include <sys/prctl.h>
+#include <sys/ptrace.h>
+#include <sys/signalfd.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -52,13 +55,57 @@
 #include "libhfcommon/log.h"
 #include "libhfcommon/ns.h"
 #include "libhfcommon/util.h"
+#include "linux/cgroup.h"
 #include "linux/perf.h"
 #include "linux/trace.h"
 #include "sanitizers.h"
 #include "subproc.h"
 
+#if !defined(CLONE_PIDFD)
+#define CLONE_PIDFD 0x00001000
+#endif /* !defined(CLONE_PIDFD) */
+
 static uint8_t arch_clone_stack[128 * 1024] __attribute__((aligned(__BIGGEST_ALIGNMENT__)));
 static __thread jmp_buf env;
+/* Set once clone3() turns out to be unavailable (old kernel, or blocked by seccomp) */
+static bool arch_clone3Unsupported = false;
+/* Set once pidfd_open() turns out to be unavailable */
+static bool arch_pidFdUnsupported = false;
+
+/*
+ * Pidfds of processes forked by this thread, till they're taken with arch_pidFdTake(), e.g. by
+ * arch_prepareParentAfterFork(), or when a spare process is killed
+ */
+static __thread struct {
+    pid_t pid;
+    int fd;
+} arch_pidFds[_HF_SPARES_MAX + 2];
+
+static void arch_pidFdAdd(pid_t pid, int fd) {
+    if (fd == -1) {
+        return;
+    }
+    /* Slots of processes which are still around are never reused, their pidfds are needed */
+    for (size_t i = 0; i < ARRAYSIZE(arch_pidFds); i++) {
+        if (arch_pidFds[i].pid == 0) {
+            arch_pidFds[i].pid = pid;
+            arch_pidFds[i].fd = fd;
+            return;
+        }
+    }
+    LOG_W("No free pidfd slot for pid=%d, it will be signaled with kill()", (int)pid);
+    close(fd);
+}
+
+int arch_pidFdTake(pid_t pid) {
+    for (size_t i = 0; i < ARRAYSIZE(arch_pidFds); i++) {
+        if (arch_pidFds[i].pid == pid) {
+            arch_pidFds[i].pid = 0;
+            return arch_pidFds[i].fd;
+        }
+    }
+    return -1;
+}
 
 HF_ATTR_NO_SANITIZE_ADDRESS
 HF_ATTR_NO_SANITIZE_MEMORY
@@ -66,13 +113,56 @@ __attribute__((noreturn)) static int arch_cloneFunc(void* arg HF_ATTR_UNUSED) {
     longjmp(env, 1);
 }
 
+/*
+ * clone3() without a new stack works like fork(): the child continues on a copy of the parent's
+ * stack, so no trampoline (with a stack shared between threads) is needed, and it returns a pidfd
+ */
+static pid_t arch_clone3(uintptr_t flags, int* pidfd) {
+#if defined(__NR_clone3)
+    if (ATOMIC_GET(arch_clone3Unsupported)) {
+        return -1;
+    }
+    /* struct clone_args (CLONE_ARGS_SIZE_VER0) */
+    struct {
+        uint64_t flags;
+        uint64_t pidfd;
+        uint64_t child_tid;
+        uint64_t parent_tid;
+        uint64_t exit_signal;
+        uint64_t stack;
+        uint64_t stack_size;
+        uint64_t tls;
+    } args = {
+        .flags = (flags & ~(uintptr_t)CSIGNAL) | CLONE_PIDFD,
+        .pidfd = (uint64_t)(uintptr_t)pidfd,
+        .exit_signal = flags & CSIGNAL,
+    };
+    long ret = syscall(__NR_clone3, &args, sizeof(args));
+    if (ret == -1 && (errno == ENOSYS || errno == EPERM)) {
+        PLOG_D("clone3() is not available, falling back to clone()");
+        ATOMIC_SET(arch_clone3Unsupported, true);
+    }
+    return (pid_t)ret;
+#else  /* defined(__NR_clone3) */
+    (void)flags;
+    (void)pidfd;
+    return -1;
+#endif /* defined(__NR_clone3) */
+}
+
 /* Avoid problem with caching of PID/TID in glibc */
-static pid_t arch_clone(uintptr_t flags) {
+static pid_t arch_clone(uintptr_t flags, int* pidfd) {
     if (flags & CLONE_VM) {
         LOG_E("Cannot use clone(flags & CLONE_VM)");
         return -1;
     }
 
+    *pidfd = -1;
+    pid_t pid = arch_clone3(flags, pidfd);
+    if (pid != -1 || !ATOMIC_GET(arch_clone3Unsupported)) {
+        return pid;
+    }
+
     if (setjmp(env) == 0) {
         void* stack_mid = &arch_clone_stack[sizeof(arch_clone_stack) / 2];
         /* Parent */
@@ -83,7 +173,9 @@ static pid_t arch_clone(uintptr_t flags) {
 }
 
 pid_t arch_fork(run_t* run) {
-    pid_t pid = run->global->linux.useClone ? arch_clone(CLONE_UNTRACED | SIGCHLD) : fork();
+    int pidfd = -1;
+    pid_t pid =
+        run->global->linux.useClone ? arch_clone(CLONE_UNTRACED | SIGCHLD, &pidfd) : fork();
     if (pid == -1) {
         return pid;
     }
@@ -94,6 +186,17 @@ pid_t arch_fork(run_t* run) {
         }
         return pid;
     }
+#if defined(__NR_pidfd_open)
+    /* glibc's fork() (or an old kernel) didn't provide one */
+    if (pidfd == -1 && !ATOMIC_GET(arch_pidFdUnsupported)) {
+        pidfd = syscall(__NR_pidfd_open, pid, 0);
+        if (pidfd == -1 && (errno == ENOSYS || errno == EPERM)) {
+            PLOG_D("pidfd_open() is not available");
+            ATOMIC_SET(arch_pidFdUnsupported, true);
+        }
+    }
+#endif /* defined(__NR_pidfd_open) */
+    arch_pidFdAdd(pid, pidfd);
     return pid;
 }
 
@@ -102,6 +205,10 @@ bool arch_launchChild(run_t* run) {
         LOG_W("Cannot bring interface 'lo' up");
     }
 
+    if (!arch_cgroupJoin(run)) {
+        return false;
+    }
+
     /*
      * Make it attach-able by ptrace()
      */
@@ -121,6 +228,10 @@ bool arch_launchChild(run_t* run) {
         PLOG_E("setenv(MALLOC_PERTURB_=85) failed");
         return false;
     }
+    if (run->global->linux.useSnapshot && setenv(_HF_SNAPSHOT_ENV, "1", 1) == -1) {
+        PLOG_E("setenv(" _HF_SNAPSHOT_ENV "=1) failed");
+        return false;
+    }
 
     /* Increase our OOM score, so fuzzed processes die faster */
     static const char score100[] = "+500";
@@ -147,7 +258,10 @@ bool arch_launchChild(run_t* run) {
         LOG_F("Couldn't stop itself");
     }
 #if defined(__NR_execveat)
-    syscall(__NR_execveat, run->global->linux.exeFd, "", run->args, environ, AT_EMPTY_PATH);
+    /* linux.exeFd refers to the main binary, so it can't be used with the sanitizer build */
+    if (!run->isSanitizerBuild) {
+        syscall(__NR_execveat, run->global->linux.exeFd, "", run->args, environ, AT_EMPTY_PATH);
+    }
 #endif /* defined__NR_execveat) */
     execve(run->args[0], (char* const*)run->args, environ);
     int errno_cpy = errno;
@@ -169,6 +283,11 @@ static bool arch_attachToNewPid(run_t* run) {
 
 void arch_prepareParentAfterFork(run_t* run) {
     /* Parent */
+    if (run->linux.pidFd != -1) {
+        close(run->linux.pidFd);
+    }
+    run->linux.pidFd = arch_pidFdTake(run->pid);
+
     if (run->global->exe.persistent) {
         const struct f_owner_ex fown = {
             .type = F_OWNER_TID,
@@ -224,7 +343,7 @@ static bool arch_checkWait(run_t* run) {
 
         if (pid == run->pid && (WIFEXITED(status) || WIFSIGNALED(status))) {
             if (run->global->exe.persistent) {
-                if (!fuzz_isTerminating()) {
+                if (!fuzz_isTerminating() && run->runState != _HF_RS_RECYCLING) {
                     LOG_W("Persistent mode: pid=%d exited with status: %s", (int)run->pid,
                         subproc_StatusToStr(status, statusStr, sizeof(statusStr)));
                 }
@@ -257,6 +376,11 @@ void arch_reapChild(run_t* run) {
             run->pid = 0;
             break;
         }
+        /* The process has been resumed by now, prepare the next input while it's running */
+        if (!run->global->exe.persistent) {
+            fuzz_prepareNextInput(run);
+            subproc_prepareSpares(run);
+        }
         if (run->global->socketFuzzer.enabled) {
             // Do not wait for new events
             break;
@@ -264,6 +388,164 @@ void arch_reapChild(run_t* run) {
     }
 
     arch_perfAnalyze(run);
+    arch_cgroupAnalyze(run);
+}
+
+/* Processes started by the same thread are told apart by their session (= process group) id */
+static run_t* arch_findRun(run_t* runs, size_t cnt, pid_t pid) {
+    for (size_t i = 0; i < cnt; i++) {
+        if (runs[i].pid == pid) {
+            return &runs[i];
+        }
+    }
+    pid_t pgid = getpgid(pid);
+    for (size_t i = 0; i < cnt && pgid > 0; i++) {
+        if (runs[i].pid == pgid) {
+            return &runs[i];
+        }
+    }
+    return NULL;
+}
+
+static void arch_checkWaitMux(run_t* runs, const bool running[], bool done[], size_t cnt) {
+    for (;;) {
+        /* Peek first, so the process is still around for getpgid() */
+        siginfo_t si = {.si_pid = 0};
+        if (waitid(P_ALL, 0, &si, WEXITED | WSTOPPED | WNOHANG | WNOWAIT | __WALL | __WNOTHREAD) ==
+            -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ECHILD) {
+                return;
+            }
+            PLOG_F("waitid() failed");
+        }
+        if (si.si_pid == 0) {
+            return;
+        }
+
+        pid_t pid = si.si_pid;
+        run_t* run = arch_findRun(runs, cnt, pid);
+
+        int status;
+        if (TEMP_FAILURE_RETRY(waitpid(pid, &status, __WALL | __WNOTHREAD | WNOHANG)) != pid) {
+            PLOG_W("waitpid(pid=%d)", (int)pid);
+            continue;
+        }
+
+        char statusStr[4096];
+        LOG_D("pid=%d returned with status: %s", pid,
+            subproc_StatusToStr(status, statusStr, sizeof(statusStr)));
+
+        if (run == NULL) {
+            LOG_D("pid=%d doesn't belong to any of the fuzzed processes", (int)pid);
+            if (WIFSTOPPED(status)) {
+                ptrace(PTRACE_CONT, pid, 0, 0);
+            }
+            continue;
+        }
+
+        arch_traceAnalyze(run, status, pid);
+
+        if (pid == run->pid && (WIFEXITED(status) || WIFSIGNALED(status))) {
+            if (run->global->exe.persistent && !fuzz_isTerminating() &&
+                run->runState != _HF_RS_RECYCLING) {
+                LOG_W("Persistent mode: pid=%d exited with status: %s", (int)run->pid,
+                    subproc_StatusToStr(status, statusStr, sizeof(statusStr)));
+            }
+            run->pid = 0;
+            size_t i = run - runs;
+            done[i] = running[i];
+        }
+    }
+}
+
+/* Marks the signalfd in epoll events, the other ones carry indices of runs */
+#define ARCH_REAP_SIGFD_EV UINT64_MAX
+
+void arch_reapChildren(run_t* runs, const bool running[], bool done[], size_t cnt) {
+    run_t* r0 = &runs[0];
+    if (r0->linux.reapEpollFd == -1) {
+        if ((r0->linux.reapEpollFd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+            PLOG_F("epoll_create1()");
+        }
+        /* SIGCHLD (also pinged by the main thread) and SIGIO end up here */
+        if ((r0->linux.reapSigFd = signalfd(
+                 -1, &r0->global->exe.waitSigSet, SFD_NONBLOCK | SFD_CLOEXEC)) == -1) {
+            PLOG_F("signalfd()");
+        }
+        struct epoll_event ev = {.events = EPOLLIN, .data.u64 = ARCH_REAP_SIGFD_EV};
+        if (epoll_ctl(r0->linux.reapEpollFd, EPOLL_CTL_ADD, r0->linux.reapSigFd, &ev) == -1) {
+            PLOG_F("epoll_ctl(EPOLL_CTL_ADD, fd=%d)", r0->linux.reapSigFd);
+        }
+    }
+    if (r0->linux.reapPidsCnt < cnt) {
+        r0->linux.reapPids = (pid_t*)util_Realloc(r0->linux.reapPids, cnt * sizeof(pid_t));
+        memset(&r0->linux.reapPids[r0->linux.reapPidsCnt], '\0',
+            (cnt - r0->linux.reapPidsCnt) * sizeof(pid_t));
+        r0->linux.reapPidsCnt = cnt;
+    }
+    const int epollFd = r0->linux.reapEpollFd;
+    const int sigFd = r0->linux.reapSigFd;
+    pid_t* epollPids = r0->linux.reapPids;
+
+    for (size_t i = 0; i < cnt; i++) {
+        if (!running[i]) {
+            continue;
+        }
+        run_t* run = &runs[i];
+        if (run->global->exe.persistent) {
+            /* A new persistent process comes with a new socket */
+            if (epollPids[i] != run->pid) {
+                struct epoll_event ev = {.events = EPOLLIN, .data.u64 = i};
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, run->persistentSock, &ev) == -1 &&
+                    errno != EEXIST) {
+                    PLOG_F("epoll_ctl(EPOLL_CTL_ADD, fd=%d)", run->persistentSock);
+                }
+                epollPids[i] = run->pid;
+            }
+            /* Only the size indicator is waiting to be sent, the socket will not become readable */
+            if (run->runState == _HF_RS_SEND_DATA && subproc_persistentModeStateMachine(run)) {
+                done[i] = true;
+                continue;
+            }
+        }
+        subproc_checkTimeLimit(run);
+        subproc_checkTermination(run);
+    }
+
+    struct epoll_event events[64];
+    int nfds = epoll_wait(epollFd, events, ARRAYSIZE(events), 100 /* 0.1s */);
+    if (nfds == -1 && errno != EINTR) {
+        PLOG_F("epoll_wait()");
+    }
+
+    for (int i = 0; i < nfds; i++) {
+        if (events[i].data.u64 == ARCH_REAP_SIGFD_EV) {
+            struct signalfd_siginfo ssi;
+            while (read(sigFd, &ssi, sizeof(ssi)) == sizeof(ssi)) {
+            }
+            continue;
+        }
+        size_t idx = (size_t)events[i].data.u64;
+        if (idx >= cnt) {
+            continue;
+        }
+        if (running[idx] && !done[idx] && subproc_persistentModeStateMachine(&runs[idx])) {
+            done[idx] = true;
+        }
+    }
+
+    /* Signals can be coalesced, or consumed elsewhere, so always check for finished processes */
+    arch_checkWaitMux(runs, running, done, cnt);
+
+    for (size_t i = 0; i < cnt; i++) {
+        if (done[i]) {
+            arch_perfAnalyze(&runs[i]);
+            arch_cgroupAnalyze(&runs[i]);
+        }
+    }
 }
 
 bool arch_archInit(honggfuzz_t* hfuzz) {
@@ -353,6 +635,12 @@ bool arch_archInit(honggfuzz_t* hfuzz) {
             return false;
         }
     }
+    if ((hfuzz->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK) && !arch_traceBpInit(hfuzz)) {
+        return false;
+    }
+    if (hfuzz->linux.cgroupDir && !arch_cgroupInit(hfuzz)) {
+        return false;
+    }
 #if defined(__ANDROID__) && defined(__arm__) && defined(OPENSSL_ARMCAP_ABI)
     /*
      * For ARM kernels running Android API <= 21, if fuzzing target links to
@@ -383,10 +671,39 @@ bool arch_archThreadInit(run_t* run) {
     run->linux.cpuInstrFd = -1;
     run->linux.cpuBranchFd = -1;
     run->linux.cpuIptBtsFd = -1;
+    run->linux.bpPid = 0;
+    run->linux.pidFd = -1;
+    run->linux.reapEpollFd = -1;
+    run->linux.reapSigFd = -1;
+    run->linux.reapPids = NULL;
+    run->linux.reapPidsCnt = 0;
 
     if (prctl(PR_SET_CHILD_SUBREAPER, 1UL, 0UL, 0UL, 0UL) == -1) {
         PLOG_W("prctl(PR_SET_CHILD_SUBREAPER, 1)");
     }
 
+    if (!arch_cgroupThreadInit(run)) {
+        return false;
+    }
+
     return true;
 }
+
+void arch_archThreadDestroy(run_t* run) {
+    if (run->linux.pidFd != -1) {
+        close(run->linux.pidFd);
+        run->linux.pidFd = -1;
+    }
+    if (run->linux.reapEpollFd != -1) {
+        close(run->linux.reapEpollFd);
+        run->linux.reapEpollFd = -1;
+    }
+    if (run->linux.reapSigFd != -1) {
+        close(run->linux.reapSigFd);
+        run->linux.reapSigFd = -1;
+    }
+    free(run->linux.reapPids);
+    run->linux.reapPids = NULL;
+    run->linux.reapPidsCnt = 0;
+    arch_cgroupThreadDestroy(run);
+}
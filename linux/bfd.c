@@ -245,4 +245,198 @@ void arch_bfdDisasm(pid_t pid, uint8_t* mem, size_t size, char* instr) {
     bfd_close(bfdh);
 }
 
+static bool arch_bfdIsPrefix(const char* str) {
+    static const char* const prefixes[] = {
+        "bnd", "notrack", "rep", "repz", "repnz", "ds", "cs", "data16", "addr32", "lock"};
+    for (size_t i = 0; i < ARRAYSIZE(prefixes); i++) {
+        if (strcmp(str, prefixes[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Whether the disassembled (x86, AT&T syntax) instruction ends a basic block, and where it jumps
+ * to if it's a direct branch
+ */
+static bool arch_bfdIsBranch(const char* instr, uint64_t* target) {
+    char buf[_HF_INSTR_SZ];
+    snprintf(buf, sizeof(buf), "%s", instr);
+
+    char* saveptr = NULL;
+    char* mnemonic = strtok_r(buf, " \t", &saveptr);
+    while (mnemonic && arch_bfdIsPrefix(mnemonic)) {
+        mnemonic = strtok_r(NULL, " \t", &saveptr);
+    }
+    if (!mnemonic) {
+        return false;
+    }
+    if (mnemonic[0] != 'j' && !util_strStartsWith(mnemonic, "call") &&
+        !util_strStartsWith(mnemonic, "ret") && !util_strStartsWith(mnemonic, "loop")) {
+        return false;
+    }
+
+    *target = 0;
+    const char* op = strtok_r(NULL, " \t", &saveptr);
+    if (op && util_strStartsWith(op, "0x") && !strchr(op, '(')) {
+        *target = strtoull(op, NULL, 16);
+    }
+    return true;
+}
+
+static void arch_bfdAddBlock(bpBlock_t** blocks, size_t* cnt, size_t* capacity, uint64_t addr,
+    const uint8_t* contents, uint64_t vma, uint64_t sz) {
+    if (addr < vma || addr >= (vma + sz)) {
+        return;
+    }
+    /* A breakpoint can't be told apart from an int3 which was there already */
+    if (contents[addr - vma] == 0xCC) {
+        return;
+    }
+    if (*cnt == *capacity) {
+        *capacity = *capacity ? (*capacity * 2) : 4096;
+        *blocks = (bpBlock_t*)util_Realloc(*blocks, *capacity * sizeof(bpBlock_t));
+    }
+    (*blocks)[*cnt].addr = addr;
+    (*blocks)[*cnt].origByte = contents[addr - vma];
+    (*cnt)++;
+}
+
+static int arch_bfdCmpBlocks(const void* a, const void* b) {
+    const bpBlock_t* ba = (const bpBlock_t*)a;
+    const bpBlock_t* bb = (const bpBlock_t*)b;
+    if (ba->addr == bb->addr) {
+        return 0;
+    }
+    return (ba->addr < bb->addr) ? -1 : 1;
+}
+
+/*
+ * Finds starts of basic blocks in the code sections of the binary with a linear sweep: function
+ * symbols, targets of direct branches, and instructions following branches. Returns the number of
+ * blocks, sorted by their (link-time) addresses.
+ */
+size_t arch_bfdBasicBlocks(const char* fname, bpBlock_t** blocks, uint64_t* loadVma) {
+    MX_SCOPED_LOCK(&arch_bfd_mutex);
+
+    bfd_init();
+
+    bfd* bfdh = bfd_openr(fname, NULL);
+    if (bfdh == NULL) {
+        LOG_E("bfd_openr('%s') failed", fname);
+        return 0;
+    }
+    defer {
+        bfd_close(bfdh);
+    };
+    if (!bfd_check_format(bfdh, bfd_object)) {
+        LOG_E("bfd_check_format('%s') failed", fname);
+        return 0;
+    }
+    if (bfd_get_arch(bfdh) != bfd_arch_i386) {
+        LOG_E("'%s' is not an x86/x86-64 binary", fname);
+        return 0;
+    }
+#if defined(_HF_BFD_GE_2_29)
+    disassembler_ftype disassemble =
+        disassembler(bfd_get_arch(bfdh), bfd_little_endian(bfdh) ? FALSE : TRUE, 0, NULL);
+#else
+    disassembler_ftype disassemble = disassembler(bfdh);
+#endif  // defined(_HD_BFD_GE_2_29)
+    if (disassemble == NULL) {
+        LOG_E("disassembler() failed");
+        return 0;
+    }
+
+    /* The symbol table is optional, stripped binaries don't have it */
+    asymbol** syms = NULL;
+    long symsCnt = 0;
+    long storage_needed = bfd_get_symtab_upper_bound(bfdh);
+    if (storage_needed > 0) {
+        syms = (asymbol**)util_Calloc(storage_needed);
+        symsCnt = bfd_canonicalize_symtab(bfdh, syms);
+    }
+    defer {
+        free(syms);
+    };
+
+    *loadVma = UINT64_MAX;
+    for (struct bfd_section* section = bfdh->sections; section; section = section->next) {
+        if ((section->flags & SEC_LOAD) && bfd_get_section_vma(bfdh, section) < *loadVma) {
+            *loadVma = bfd_get_section_vma(bfdh, section);
+        }
+    }
+    *loadVma &= ~((uint64_t)getpagesize() - 1);
+
+    char instr[_HF_INSTR_SZ];
+    struct disassemble_info info;
+    init_disassemble_info(&info, instr, arch_bfdFPrintF);
+    info.arch = bfd_get_arch(bfdh);
+    info.mach = bfd_get_mach(bfdh);
+    info.endian = bfd_little_endian(bfdh) ? BFD_ENDIAN_LITTLE : BFD_ENDIAN_BIG;
+
+    *blocks = NULL;
+    size_t cnt = 0, capacity = 0;
+    for (struct bfd_section* section = bfdh->sections; section; section = section->next) {
+        /* PLT stubs are not part of the program logic */
+        if (!(section->flags & SEC_CODE) || !(section->flags & SEC_LOAD) ||
+            strncmp(section->name, ".plt", 4) == 0) {
+            continue;
+        }
+        uint64_t vma = bfd_get_section_vma(bfdh, section);
+        uint64_t sz = bfd_get_section_size(section);
+        if (sz == 0) {
+            continue;
+        }
+        uint8_t* contents = (uint8_t*)util_Malloc(sz);
+        defer {
+            free(contents);
+        };
+        if (!bfd_get_section_contents(bfdh, section, contents, 0, sz)) {
+            LOG_W("Couldn't read section '%s' of '%s'", section->name, fname);
+            continue;
+        }
+
+        info.section = section;
+        info.buffer = contents;
+        info.buffer_vma = vma;
+        info.buffer_length = sz;
+        disassemble_init_for_target(&info);
+
+        arch_bfdAddBlock(blocks, &cnt, &capacity, vma, contents, vma, sz);
+        for (long i = 0; i < symsCnt; i++) {
+            if (syms[i]->section == section && (syms[i]->flags & BSF_FUNCTION)) {
+                arch_bfdAddBlock(
+                    blocks, &cnt, &capacity, bfd_asymbol_value(syms[i]), contents, vma, sz);
+            }
+        }
+        for (uint64_t pc = vma; pc < (vma + sz);) {
+            instr[0] = '\0';
+            int len = disassemble(pc, &info);
+            if (len <= 0) {
+                break;
+            }
+            uint64_t target;
+            if (arch_bfdIsBranch(instr, &target)) {
+                arch_bfdAddBlock(blocks, &cnt, &capacity, pc + len, contents, vma, sz);
+                arch_bfdAddBlock(blocks, &cnt, &capacity, target, contents, vma, sz);
+            }
+            pc += len;
+        }
+    }
+
+    if (cnt == 0) {
+        return 0;
+    }
+    qsort(*blocks, cnt, sizeof(bpBlock_t), arch_bfdCmpBlocks);
+    size_t uniq = 1;
+    for (size_t i = 1; i < cnt; i++) {
+        if ((*blocks)[i].addr != (*blocks)[uniq - 1].addr) {
+            (*blocks)[uniq++] = (*blocks)[i];
+        }
+    }
+    return uniq;
+}
+
 #endif /*  !defined(_HF_LINUX_NO_BFD)  */
@@ -29,6 +29,7 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include "honggfuzz.h"
 #include "linux/unwind.h"
 
 #define _HF_INSTR_SZ 64
@@ -41,6 +42,7 @@
 extern void arch_bfdDemangle(funcs_t* funcs, size_t funcCnt);
 extern void arch_bfdResolveSyms(pid_t pid, funcs_t* funcs, size_t num);
 extern void arch_bfdDisasm(pid_t pid, uint8_t* mem, size_t size, char* instr);
+extern size_t arch_bfdBasicBlocks(const char* fname, bpBlock_t** blocks, uint64_t* loadVma);
 
 #endif /* !defined(_HF_LINUX_NO_BFD) */
 
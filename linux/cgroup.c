@@ -0,0 +1,288 @@
+/*
+ *
+ * honggfuzz - architecture dependent code (LINUX/CGROUP)
+ * -----------------------------------------
+ *
+ * Author: Robert Swiecki <swiecki@google.com>
+ *
+ * Copyright 2010-2018 by Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+ * implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ */
+
+#include "cgroup.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "libhfcommon/common.h"
+#include "libhfcommon/log.h"
+#include "libhfcommon/util.h"
+
+#if !defined(CGROUP2_SUPER_MAGIC)
+#define CGROUP2_SUPER_MAGIC 0x63677270
+#endif /* !defined(CGROUP2_SUPER_MAGIC) */
+
+/* Run cgroups are called honggfuzz.<pid>.<fuzzNo>, so concurrent instances can share the dir */
+#define CGROUP_PREFIX "honggfuzz."
+
+static bool arch_cgroupWrite(int dirFd, const char* fname, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+static bool arch_cgroupWrite(int dirFd, const char* fname, const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    int fd = TEMP_FAILURE_RETRY(openat(dirFd, fname, O_WRONLY | O_CLOEXEC));
+    if (fd == -1) {
+        PLOG_W("Couldn't open '%s'", fname);
+        return false;
+    }
+    defer {
+        close(fd);
+    };
+    if (TEMP_FAILURE_RETRY(write(fd, buf, strlen(buf))) == -1) {
+        PLOG_W("Couldn't write '%s' to '%s'", buf, fname);
+        return false;
+    }
+    return true;
+}
+
+bool arch_cgroupInit(honggfuzz_t* hfuzz) {
+    struct statfs st;
+    if (statfs(hfuzz->linux.cgroupDir, &st) == -1) {
+        PLOG_E("statfs('%s')", hfuzz->linux.cgroupDir);
+        return false;
+    }
+    if (st.f_type != CGROUP2_SUPER_MAGIC) {
+        LOG_E("'%s' is not a cgroup v2 directory", hfuzz->linux.cgroupDir);
+        return false;
+    }
+
+    int dirFd = TEMP_FAILURE_RETRY(open(hfuzz->linux.cgroupDir, O_DIRECTORY | O_CLOEXEC));
+    if (dirFd == -1) {
+        PLOG_E("open('%s', O_DIRECTORY)", hfuzz->linux.cgroupDir);
+        return false;
+    }
+    defer {
+        close(dirFd);
+    };
+
+    /*
+     * Controllers must be enabled in the parent for the limits to appear in run cgroups. It's not
+     * possible if the parent has processes of its own (e.g. honggfuzz itself)
+     */
+    if (hfuzz->exe.rssLimit && !arch_cgroupWrite(dirFd, "cgroup.subtree_control", "+memory")) {
+        LOG_W("The memory controller is not available under '%s', --rlimit_rss will not be "
+              "enforced with memory.max",
+            hfuzz->linux.cgroupDir);
+    }
+    if (hfuzz->linux.cgroupPidsMax && !arch_cgroupWrite(dirFd, "cgroup.subtree_control", "+pids")) {
+        LOG_W("The pids controller is not available under '%s', --linux_cgroup_pids will not be "
+              "enforced",
+            hfuzz->linux.cgroupDir);
+    }
+    if (hfuzz->linux.cgroupCpuPct && !arch_cgroupWrite(dirFd, "cgroup.subtree_control", "+cpu")) {
+        LOG_W("The cpu controller is not available under '%s', --linux_cgroup_cpu will not be "
+              "enforced",
+            hfuzz->linux.cgroupDir);
+    }
+
+    return true;
+}
+
+bool arch_cgroupThreadInit(run_t* run) {
+    run->linux.cgroupProcsFd = -1;
+    run->linux.cgroupKillFd = -1;
+    run->linux.cgroupPeakFd = -1;
+
+    if (!run->global->linux.cgroupDir) {
+        return true;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/" CGROUP_PREFIX "%d.%" PRIu32, run->global->linux.cgroupDir,
+        (int)getpid(), run->fuzzNo);
+    if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+        PLOG_E("mkdir('%s')", path);
+        return false;
+    }
+    int dirFd = TEMP_FAILURE_RETRY(open(path, O_DIRECTORY | O_CLOEXEC));
+    if (dirFd == -1) {
+        PLOG_E("open('%s', O_DIRECTORY)", path);
+        return false;
+    }
+    defer {
+        close(dirFd);
+    };
+
+    if ((run->linux.cgroupProcsFd =
+                TEMP_FAILURE_RETRY(openat(dirFd, "cgroup.procs", O_WRONLY | O_CLOEXEC))) == -1) {
+        PLOG_E("Couldn't open '%s/cgroup.procs'", path);
+        return false;
+    }
+    /* cgroup.kill appeared in Linux 5.14, SIGKILL is sent to processes one by one without it */
+    if ((run->linux.cgroupKillFd =
+                TEMP_FAILURE_RETRY(openat(dirFd, "cgroup.kill", O_WRONLY | O_CLOEXEC))) == -1) {
+        PLOG_W("Couldn't open '%s/cgroup.kill'", path);
+    }
+    /* Resetting memory.peak (so it's per-run) works since Linux 6.12 */
+    if ((run->linux.cgroupPeakFd =
+                TEMP_FAILURE_RETRY(openat(dirFd, "memory.peak", O_RDWR | O_CLOEXEC))) == -1) {
+        PLOG_D("Couldn't open '%s/memory.peak'", path);
+    }
+
+    if (run->global->exe.rssLimit) {
+        arch_cgroupWrite(dirFd, "memory.max", "%" PRIu64, run->global->exe.rssLimit * 1024U * 1024U);
+        /* Otherwise processes crossing memory.max get swapped out, instead of being OOM-killed */
+        arch_cgroupWrite(dirFd, "memory.swap.max", "0");
+    }
+    if (run->global->linux.cgroupPidsMax) {
+        arch_cgroupWrite(dirFd, "pids.max", "%" PRIu64, run->global->linux.cgroupPidsMax);
+    }
+    if (run->global->linux.cgroupCpuPct) {
+        arch_cgroupWrite(
+            dirFd, "cpu.max", "%" PRIu64 " 100000", run->global->linux.cgroupCpuPct * 1000U);
+    }
+
+    return true;
+}
+
+/* Called in the child process, before execve() */
+bool arch_cgroupJoin(run_t* run) {
+    if (run->linux.cgroupProcsFd == -1) {
+        return true;
+    }
+    if (TEMP_FAILURE_RETRY(write(run->linux.cgroupProcsFd, "0", 1)) == -1) {
+        PLOG_E("Couldn't move the process to its cgroup");
+        return false;
+    }
+    return true;
+}
+
+/* Kills the fuzzed process together with all its descendants */
+bool arch_cgroupKill(run_t* run) {
+    if (run->linux.cgroupKillFd == -1) {
+        return false;
+    }
+    if (TEMP_FAILURE_RETRY(pwrite(run->linux.cgroupKillFd, "1", 1, 0)) == -1) {
+        PLOG_W("Couldn't write to cgroup.kill");
+        return false;
+    }
+    return true;
+}
+
+uint64_t arch_cgroupMemPeakKiB(run_t* run) {
+    if (run->linux.cgroupPeakFd == -1) {
+        return 0;
+    }
+    char buf[64];
+    ssize_t sz = TEMP_FAILURE_RETRY(pread(run->linux.cgroupPeakFd, buf, sizeof(buf) - 1, 0));
+    if (sz <= 0) {
+        return 0;
+    }
+    buf[sz] = '\0';
+    return strtoull(buf, NULL, 10) / 1024U;
+}
+
+/* Called after each run (or persistent round) */
+void arch_cgroupAnalyze(run_t* run) {
+    if (run->linux.cgroupPeakFd != -1) {
+        LOG_D("pid=%d memory.peak: %" PRIu64 " KiB", (int)run->pid, arch_cgroupMemPeakKiB(run));
+        /* Any write resets it to the current usage, for this file descriptor only */
+        if (TEMP_FAILURE_RETRY(pwrite(run->linux.cgroupPeakFd, "0", 1, 0)) == -1) {
+            PLOG_D("Couldn't reset memory.peak, closing it");
+            close(run->linux.cgroupPeakFd);
+            run->linux.cgroupPeakFd = -1;
+        }
+    }
+    /* Whatever is left after the fuzzed process has exited, escaped its process group */
+    if (run->pid == 0) {
+        arch_cgroupKill(run);
+    }
+}
+
+/* Closes the per-run cgroup files, opened by arch_cgroupThreadInit() */
+void arch_cgroupThreadDestroy(run_t* run) {
+    if (run->linux.cgroupProcsFd != -1) {
+        close(run->linux.cgroupProcsFd);
+        run->linux.cgroupProcsFd = -1;
+    }
+    if (run->linux.cgroupKillFd != -1) {
+        close(run->linux.cgroupKillFd);
+        run->linux.cgroupKillFd = -1;
+    }
+    if (run->linux.cgroupPeakFd != -1) {
+        close(run->linux.cgroupPeakFd);
+        run->linux.cgroupPeakFd = -1;
+    }
+}
+
+/* Removes run cgroups of this instance, once the fuzzing threads are done */
+void arch_cgroupCleanup(honggfuzz_t* hfuzz) {
+    if (!hfuzz->linux.cgroupDir) {
+        return;
+    }
+    int dirFd = TEMP_FAILURE_RETRY(open(hfuzz->linux.cgroupDir, O_DIRECTORY | O_CLOEXEC));
+    if (dirFd == -1) {
+        PLOG_W("open('%s', O_DIRECTORY)", hfuzz->linux.cgroupDir);
+        return;
+    }
+    DIR* dir = fdopendir(dirFd);
+    if (!dir) {
+        PLOG_W("fdopendir('%s')", hfuzz->linux.cgroupDir);
+        close(dirFd);
+        return;
+    }
+    defer {
+        closedir(dir);
+    };
+
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), CGROUP_PREFIX "%d.", (int)getpid());
+    for (struct dirent* entry; (entry = readdir(dir));) {
+        if (strncmp(entry->d_name, prefix, strlen(prefix)) != 0) {
+            continue;
+        }
+        int cgFd = TEMP_FAILURE_RETRY(openat(dirFd, entry->d_name, O_DIRECTORY | O_CLOEXEC));
+        if (cgFd != -1) {
+            arch_cgroupWrite(cgFd, "cgroup.kill", "1");
+            close(cgFd);
+        }
+        /* Killed processes leave the cgroup asynchronously */
+        for (int i = 0; i < 100; i++) {
+            if (unlinkat(dirFd, entry->d_name, AT_REMOVEDIR) == 0) {
+                break;
+            }
+            if (errno != EBUSY || i == 99) {
+                PLOG_W("Couldn't remove cgroup '%s/%s'", hfuzz->linux.cgroupDir, entry->d_name);
+                break;
+            }
+            util_sleepForMSec(10);
+        }
+    }
+}
@@ -48,11 +48,13 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "input.h"
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
 #include "libhfcommon/util.h"
 #include "linux/bfd.h"
+#include "linux/cgroup.h"
 #include "linux/unwind.h"
 #include "report.h"
 #include "sanitizers.h"
@@ -533,6 +535,8 @@ static void arch_traceSaveData(run_t* run, pid_t pid) {
     char instr[_HF_INSTR_SZ] = "\x00";
     siginfo_t si = {};
 
+    input_syncChildMutation(run);
+
     if (ptrace(PTRACE_GETSIGINFO, pid, 0, &si) == -1) {
         PLOG_W("Couldn't get siginfo for pid %d", pid);
     }
@@ -628,6 +632,7 @@ static void arch_traceSaveData(run_t* run, pid_t pid) {
 
     /* Increase global crashes counter */
     ATOMIC_POST_INC(run->global->cnts.crashesCnt);
+    run->crashed = true;
 
     /*
      * Check if backtrace contains whitelisted symbol. Whitelist overrides
@@ -726,12 +731,277 @@ static void arch_traceSaveData(run_t* run, pid_t pid) {
     ATOMIC_CLEAR(run->global->cfg.dynFileIterExpire);
 
     report_appendReport(pid, run, funcs, funcCnt, pc, crashAddr, si.si_signo, instr, description);
+    if (run->linux.cgroupPeakFd != -1) {
+        util_ssnprintf(run->report, sizeof(run->report), "MEMORY PEAK: %" PRIu64 " KiB\n",
+            arch_cgroupMemPeakKiB(run));
+    }
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+#define _HF_BP_INSTR 0xCC
+
+static bool arch_traceBpIsHit(honggfuzz_t* hfuzz, size_t idx) {
+    return (ATOMIC_GET(hfuzz->linux.bp.hitMap[idx / 8]) & (1U << (idx % 8)));
+}
+
+/*
+ * Load bias of the fuzzed binary in the process, it's false if the process runs a different binary
+ * (e.g. a child of the fuzzed process executed something else)
+ */
+static bool arch_traceBpGetBase(run_t* run, pid_t pid, uint64_t* base) {
+    if (pid == run->linux.bpPid) {
+        *base = run->linux.bpBase;
+        return true;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/proc/%d/exe", (int)pid);
+    struct stat st;
+    if (stat(path, &st) == -1) {
+        PLOG_D("stat('%s')", path);
+        return false;
+    }
+    if (st.st_dev != run->global->linux.bp.dev || st.st_ino != run->global->linux.bp.ino) {
+        return false;
+    }
+    char exe[PATH_MAX];
+    ssize_t exeLen = readlink(path, exe, sizeof(exe) - 1);
+    if (exeLen == -1) {
+        PLOG_D("readlink('%s')", path);
+        return false;
+    }
+    exe[exeLen] = '\0';
+
+    snprintf(path, sizeof(path), "/proc/%d/maps", (int)pid);
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        PLOG_D("fopen('%s')", path);
+        return false;
+    }
+    defer {
+        fclose(f);
+    };
+
+    char* line = NULL;
+    size_t lineSz = 0;
+    defer {
+        free(line);
+    };
+    while (getline(&line, &lineSz, f) > 0) {
+        uint64_t start, offset;
+        int nameOff = 0;
+        if (sscanf(line, "%" SCNx64 "-%*x %*s %" SCNx64 " %*s %*u %n", &start, &offset,
+                &nameOff) != 2 ||
+            nameOff == 0) {
+            continue;
+        }
+        line[strcspn(line, "\n")] = '\0';
+        if (offset == 0 && strcmp(&line[nameOff], exe) == 0) {
+            *base = start - run->global->linux.bp.loadVma;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Places breakpoints at all blocks which haven't been hit by any of the fuzzed processes yet */
+static void arch_traceBpInsert(run_t* run, pid_t pid) {
+    uint64_t base;
+    if (!arch_traceBpGetBase(run, pid, &base)) {
+        LOG_D("pid=%d doesn't execute the fuzzed binary", (int)pid);
+        return;
+    }
+    run->linux.bpPid = pid;
+    run->linux.bpBase = base;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/proc/%d/mem", (int)pid);
+    /* Unlike process_vm_writev(), it can write to read-only (code) pages */
+    int fd = TEMP_FAILURE_RETRY(open(path, O_RDWR | O_CLOEXEC));
+    if (fd == -1) {
+        PLOG_W("Couldn't open '%s'", path);
+        return;
+    }
+    defer {
+        close(fd);
+    };
+
+    const bpBlock_t* blocks = run->global->linux.bp.blocks;
+    size_t blocksCnt = run->global->linux.bp.blocksCnt;
+    size_t insertedCnt = 0;
+    /* Blocks are sorted, patch them in chunks, with one read and one write per chunk */
+    uint8_t buf[4096];
+    for (size_t i = 0; i < blocksCnt;) {
+        size_t end = i;
+        bool missing = false;
+        for (; end < blocksCnt && (blocks[end].addr - blocks[i].addr) < sizeof(buf); end++) {
+            missing |= !arch_traceBpIsHit(run->global, end);
+        }
+        if (!missing) {
+            i = end;
+            continue;
+        }
+
+        uint64_t start = blocks[i].addr;
+        size_t len = blocks[end - 1].addr - start + 1;
+        if (pread(fd, buf, len, (off_t)(base + start)) != (ssize_t)len) {
+            PLOG_W("pread('%s', addr=%#" PRIx64 ", len=%zu)", path, base + start, len);
+            return;
+        }
+        for (; i < end; i++) {
+            if (!arch_traceBpIsHit(run->global, i)) {
+                buf[blocks[i].addr - start] = _HF_BP_INSTR;
+                insertedCnt++;
+            }
+        }
+        if (pwrite(fd, buf, len, (off_t)(base + start)) != (ssize_t)len) {
+            PLOG_W("pwrite('%s', addr=%#" PRIx64 ", len=%zu)", path, base + start, len);
+            return;
+        }
+    }
+    LOG_D("Placed %zu breakpoints in pid=%d, base=%#" PRIx64, insertedCnt, (int)pid, base);
+}
+
+static const bpBlock_t* arch_traceBpFind(honggfuzz_t* hfuzz, uint64_t addr) {
+    const bpBlock_t* blocks = hfuzz->linux.bp.blocks;
+    size_t lo = 0, hi = hfuzz->linux.bp.blocksCnt;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (blocks[mid].addr == addr) {
+            return &blocks[mid];
+        }
+        if (blocks[mid].addr < addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * If the process stopped at one of our breakpoints, records the block, removes the breakpoint and
+ * rewinds the process to re-execute the original instruction
+ */
+static bool arch_traceBpHit(run_t* run, pid_t pid) {
+    siginfo_t si;
+    if (ptrace(PTRACE_GETSIGINFO, pid, 0, &si) == -1) {
+        PLOG_W("Couldn't get siginfo for pid %d", pid);
+        return false;
+    }
+    /* int3 is reported with SI_KERNEL, unlike e.g. raise(SIGTRAP) or single-stepping */
+    if (si.si_code != SI_KERNEL) {
+        return false;
+    }
+
+    HEADERS_STRUCT regs;
+    struct iovec pt_iov = {
+        .iov_base = &regs,
+        .iov_len = sizeof(regs),
+    };
+    if (ptrace(PTRACE_GETREGSET, pid, NT_PRSTATUS, &pt_iov) == -1L) {
+        PLOG_W("ptrace(PTRACE_GETREGSET, pid=%d)", pid);
+        return false;
+    }
+    struct user_regs_struct_32* r32 = (struct user_regs_struct_32*)&regs;
+    struct user_regs_struct_64* r64 = (struct user_regs_struct_64*)&regs;
+    uint64_t pc;
+    if (pt_iov.iov_len == sizeof(struct user_regs_struct_32)) {
+        pc = r32->eip;
+    } else if (pt_iov.iov_len == sizeof(struct user_regs_struct_64)) {
+        pc = r64->ip;
+    } else {
+        LOG_W("Unknown registers structure size: '%zd'", pt_iov.iov_len);
+        return false;
+    }
+
+    uint64_t base;
+    if (!arch_traceBpGetBase(run, pid, &base)) {
+        return false;
+    }
+    const bpBlock_t* bp = arch_traceBpFind(run->global, pc - 1 - base);
+    if (bp == NULL) {
+        return false;
+    }
+
+    /*
+     * The breakpoint might have been removed already, after another thread of the process hit it,
+     * but this one has executed it as well
+     */
+    errno = 0;
+    long word = ptrace(PTRACE_PEEKTEXT, pid, (void*)(uintptr_t)(pc - 1), NULL);
+    if (errno != 0) {
+        PLOG_W("ptrace(PTRACE_PEEKTEXT, pid=%d, addr=%#" PRIx64 ")", pid, pc - 1);
+        return false;
+    }
+    if ((word & 0xFF) == _HF_BP_INSTR) {
+        word = (word & ~0xFFL) | bp->origByte;
+        if (ptrace(PTRACE_POKETEXT, pid, (void*)(uintptr_t)(pc - 1), (void*)word) == -1) {
+            PLOG_W("ptrace(PTRACE_POKETEXT, pid=%d, addr=%#" PRIx64 ")", pid, pc - 1);
+            return false;
+        }
+    }
+
+    if (pt_iov.iov_len == sizeof(struct user_regs_struct_32)) {
+        r32->eip = (uint32_t)(pc - 1);
+    } else {
+        r64->ip = pc - 1;
+    }
+    if (ptrace(PTRACE_SETREGSET, pid, NT_PRSTATUS, &pt_iov) == -1L) {
+        PLOG_W("ptrace(PTRACE_SETREGSET, pid=%d)", pid);
+        return false;
+    }
+
+    if (!ATOMIC_BITMAP_SET(run->global->linux.bp.hitMap, bp - run->global->linux.bp.blocks)) {
+        run->linux.hwCnts.newBBCnt++;
+    }
+    return true;
+}
+#else  /* defined(__i386__) || defined(__x86_64__) */
+static void arch_traceBpInsert(run_t* run HF_ATTR_UNUSED, pid_t pid HF_ATTR_UNUSED) {
+}
+
+static bool arch_traceBpHit(run_t* run HF_ATTR_UNUSED, pid_t pid HF_ATTR_UNUSED) {
+    return false;
+}
+#endif /* defined(__i386__) || defined(__x86_64__) */
+
+bool arch_traceBpInit(honggfuzz_t* hfuzz) {
+#if (defined(__i386__) || defined(__x86_64__)) && !defined(_HF_LINUX_NO_BFD)
+    struct stat st;
+    if (fstat(hfuzz->linux.exeFd, &st) == -1) {
+        PLOG_E("fstat(fd=%d)", hfuzz->linux.exeFd);
+        return false;
+    }
+    hfuzz->linux.bp.dev = st.st_dev;
+    hfuzz->linux.bp.ino = st.st_ino;
+
+    hfuzz->linux.bp.blocksCnt = arch_bfdBasicBlocks(
+        hfuzz->exe.cmdline[0], &hfuzz->linux.bp.blocks, &hfuzz->linux.bp.loadVma);
+    if (hfuzz->linux.bp.blocksCnt == 0) {
+        LOG_E("Couldn't find any code blocks in '%s'", hfuzz->exe.cmdline[0]);
+        return false;
+    }
+    hfuzz->linux.bp.hitMap = (uint8_t*)util_Calloc(hfuzz->linux.bp.blocksCnt / 8 + 1);
+    LOG_I("Found %zu code blocks in '%s', they will be covered with breakpoints",
+        hfuzz->linux.bp.blocksCnt, hfuzz->exe.cmdline[0]);
+
+    return true;
+#else
+    LOG_E("Breakpoint-based coverage requires libbfd, and an x86/x86-64 CPU");
+    return false;
+#endif
 }
 
 #define __WEVENT(status) ((status & 0xFF0000) >> 16)
-static void arch_traceEvent(int status, pid_t pid) {
+static void arch_traceEvent(run_t* run, int status, pid_t pid) {
     LOG_D("PID: %d, Ptrace event: %d", pid, __WEVENT(status));
     switch (__WEVENT(status)) {
+        case PTRACE_EVENT_EXEC:
+            if (run->global->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK) {
+                arch_traceBpInsert(run, pid);
+            }
+            break;
         case PTRACE_EVENT_EXIT: {
             unsigned long event_msg;
             if (ptrace(PTRACE_GETEVENTMSG, pid, NULL, &event_msg) == -1) {
@@ -761,7 +1031,13 @@ void arch_traceAnalyze(run_t* run, int status, pid_t pid) {
      * It's a ptrace event, deal with it elsewhere
      */
     if (WIFSTOPPED(status) && __WEVENT(status)) {
-        return arch_traceEvent(status, pid);
+        return arch_traceEvent(run, status, pid);
+    }
+
+    if (WIFSTOPPED(status) && WSTOPSIG(status) == SIGTRAP &&
+        (run->global->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK) && arch_traceBpHit(run, pid)) {
+        ptrace(PTRACE_CONT, pid, 0, 0);
+        return;
     }
 
     if (WIFSTOPPED(status)) {
@@ -772,8 +1048,9 @@ void arch_traceAnalyze(run_t* run, int status, pid_t pid) {
             /*
              * If fuzzer worker is from core fuzzing process run full
              * analysis. Otherwise just unwind and get stack hash signature.
+             * With a sanitizer build, it's the one which saves crashes.
              */
-            if (run->mainWorker) {
+            if (run->mainWorker && (!run->global->sanitizer.argc || run->isSanitizerBuild)) {
                 arch_traceSaveData(run, pid);
             } else {
                 arch_traceAnalyzeData(run, pid);
@@ -897,6 +1174,10 @@ bool arch_traceAttach(run_t* run) {
     if (run->global->sanitizer.enable) {
         seize_options |= PTRACE_O_TRACEEXIT;
     }
+    /* Breakpoints are placed in the freshly executed binary */
+    if (run->global->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK) {
+        seize_options |= PTRACE_O_TRACEEXEC;
+    }
 
     if (!arch_traceWaitForPidStop(run->pid)) {
         return false;
@@ -38,5 +38,6 @@ extern void arch_traceDetach(pid_t pid);
 extern void arch_traceGetCustomPerf(run_t* run, pid_t pid, uint64_t* cnt);
 extern void arch_traceSetCustomPerf(run_t* run, pid_t pid, uint64_t cnt);
 extern void arch_traceSignalsInit(honggfuzz_t* hfuzz);
+extern bool arch_traceBpInit(honggfuzz_t* hfuzz);
 
 #endif
@@ -216,6 +216,7 @@ static void arch_analyzeSignal(run_t* run, int status) {
      * Increase crashes counter presented by ASCII display
      */
     ATOMIC_POST_INC(run->global->cnts.crashesCnt);
+    run->crashed = true;
 
     /*
      * Get data from exception handler
@@ -758,3 +759,6 @@ kern_return_t catch_mach_exception_raise_state_identity(
 bool arch_archThreadInit(run_t* run HF_ATTR_UNUSED) {
     return true;
 }
+
+void arch_archThreadDestroy(run_t* run HF_ATTR_UNUSED) {
+}
@@ -24,6 +24,7 @@
 
 #include "mangle.h"
 
+#include <ctype.h>
 #include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
@@ -61,19 +62,19 @@ static inline size_t mangle_getLen(size_t max) {
         return 1;
     }
 
-    const uint64_t max2 = (uint64_t)max * max;
-    const uint64_t max3 = (uint64_t)max * max * max;
-    const uint64_t rnd = util_rndGet(1, max2 - 1);
-
-    uint64_t ret = rnd * rnd;
-    ret /= max3;
+    /*
+     * Square of a uniform value from <0.0:1.0), scaled to max. Done in floating point, as the
+     * integer version (rnd(max^2)^2 / max^3) overflows for inputs bigger than 2 MiB
+     */
+    const double rnd = (double)(util_rnd64() >> 11) / (double)(1ULL << 53);
+    uint64_t ret = (uint64_t)(rnd * rnd * (double)max);
     ret += 1;
 
     if (ret < 1) {
-        LOG_F("ret (%" PRIu64 ") < 1, max:%zu, rnd:%" PRIu64, ret, max, rnd);
+        LOG_F("ret (%" PRIu64 ") < 1, max:%zu, rnd:%f", ret, max, rnd);
     }
     if (ret > max) {
-        LOG_F("ret (%" PRIu64 ") > max (%zu), rnd:%" PRIu64, ret, max, rnd);
+        LOG_F("ret (%" PRIu64 ") > max (%zu), rnd:%f", ret, max, rnd);
     }
 
     return (size_t)ret;
@@ -736,7 +737,132 @@ static void mangle_ASCIINumInsert(run_t* run, bool printable) {
     mangle_Insert(run, off, (const uint8_t*)buf, len, printable);
 }
 
+/*
+ * Hash of a 4-byte window (long enough for most tags, keywords and delimiters), or 0 if it's a run
+ * of a single byte value (e.g. padding)
+ */
+static inline uint32_t mangle_windowHash(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    if (v == (v & 0xFF) * 0x01010101U) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)v * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static int mangle_anchorCmp(const void* a, const void* b) {
+    uint32_t ha = ((const spliceAnchor_t*)a)->hash;
+    uint32_t hb = ((const spliceAnchor_t*)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+/* Index of the first anchor with hash not lower than 'hash' */
+static size_t mangle_anchorLowerBound(const dynfile_t* dynfile, uint32_t hash) {
+    size_t lo = 0, hi = dynfile->anchorsCnt;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (dynfile->anchors[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Random pair of offsets, where the input and the splice partner share an anchor */
+static bool mangle_spliceCommonAnchor(
+    run_t* run, const dynfile_t* remote, size_t* localOff, size_t* remoteOff) {
+    if (remote->anchorsCnt == 0 || run->dynfile->size < sizeof(uint32_t)) {
+        return false;
+    }
+
+    size_t end = run->dynfile->size - sizeof(uint32_t) + 1;
+    size_t start = (end > _HF_SPLICE_SCAN_MAX) ? util_rndGet(0, end - _HF_SPLICE_SCAN_MAX) : 0;
+    end = HF_MIN(end, start + _HF_SPLICE_SCAN_MAX);
+
+    size_t found = 0;
+    for (size_t off = start; off < end; off++) {
+        uint32_t hash = mangle_windowHash(&run->dynfile->data[off]);
+        if (hash == 0 || (hash & remote->anchorsMask) != 0) {
+            continue;
+        }
+        /* Common substrings (e.g. tags) are anchors at many offsets of the remote input */
+        size_t first = mangle_anchorLowerBound(remote, hash);
+        if (first == remote->anchorsCnt || remote->anchors[first].hash != hash) {
+            continue;
+        }
+        size_t cnt = mangle_anchorLowerBound(remote, hash + 1) - first;
+        if (hash == UINT32_MAX) {
+            cnt = remote->anchorsCnt - first;
+        }
+        const spliceAnchor_t* a = &remote->anchors[first + util_rndGet(0, cnt - 1)];
+        if (memcmp(&run->dynfile->data[off], &remote->data[a->off], sizeof(uint32_t)) != 0) {
+            continue;
+        }
+        /* Reservoir sampling, so each common anchor is equally likely to be chosen */
+        if (util_rndGet(0, found++) == 0) {
+            *localOff = off;
+            *remoteOff = a->off;
+        }
+    }
+
+    return (found > 0);
+}
+
+/* Offset right after the common leading bytes (e.g. a file header) of both inputs */
+static bool mangle_spliceCommonPrefix(run_t* run, const dynfile_t* remote, size_t* off) {
+    size_t sz = HF_MIN(run->dynfile->size, remote->size);
+    size_t i = 0;
+    while (i < sz && run->dynfile->data[i] == remote->data[i]) {
+        i++;
+    }
+    if (i < 4 || i == sz) {
+        return false;
+    }
+    *off = i;
+    return true;
+}
+
+/*
+ * Splices a part of a corpus input with similar coverage, starting at a point aligned with the
+ * same content in the current input. Returns false if no such point was found
+ */
+static bool mangle_spliceAligned(run_t* run, bool insert, bool printable) {
+    if (!run->global->mutate.spliceAligned) {
+        return false;
+    }
+    const dynfile_t* remote = input_getSpliceInput(run);
+    if (remote == NULL || remote->size == 0) {
+        return false;
+    }
+
+    size_t localOff = 0, remoteOff = 0;
+    if (!mangle_spliceCommonAnchor(run, remote, &localOff, &remoteOff)) {
+        if (!mangle_spliceCommonPrefix(run, remote, &localOff)) {
+            return false;
+        }
+        remoteOff = localOff;
+    }
+
+    size_t len = remote->size - remoteOff;
+    if (!insert) {
+        len = HF_MIN(len, run->dynfile->size - localOff);
+    }
+    len = mangle_getLen(len);
+    if (insert) {
+        mangle_Insert(run, localOff, &remote->data[remoteOff], len, printable);
+    } else {
+        mangle_Overwrite(run, localOff, &remote->data[remoteOff], len, printable);
+    }
+    return true;
+}
+
 static void mangle_SpliceOverwrite(run_t* run, bool printable) {
+    if (mangle_spliceAligned(run, /* insert= */ false, printable)) {
+        return;
+    }
+
     const uint8_t* buf;
     size_t sz = input_getRandomInputAsBuf(run, &buf);
     if (!sz) {
@@ -751,6 +877,10 @@ static void mangle_SpliceOverwrite(run_t* run, bool printable) {
 }
 
 static void mangle_SpliceInsert(run_t* run, bool printable) {
+    if (mangle_spliceAligned(run, /* insert= */ true, printable)) {
+        return;
+    }
+
     const uint8_t* buf;
     size_t sz = input_getRandomInputAsBuf(run, &buf);
     if (!sz) {
@@ -807,6 +937,24 @@ static void mangle_Resize(run_t* run, bool printable) {
     }
 }
 
+/* Number of stacked mutations for the next input, more of them if it's a slow input */
+unsigned mangle_changesCnt(run_t* run, unsigned slow_factor) {
+    if (run->mutationsPerRun == 0U) {
+        return 0;
+    }
+    /* Give it a good shake-up, if it's a slow input */
+    switch (slow_factor) {
+        case 0 ... 2:
+            return util_rndGet(1, run->global->mutate.mutationsPerRun);
+        case 3 ... 4:
+            return HF_MAX(run->global->mutate.mutationsPerRun, 5);
+        case 5 ... 9:
+            return HF_MAX(run->global->mutate.mutationsPerRun, 7);
+        default:
+            return HF_MAX(run->global->mutate.mutationsPerRun, 10);
+    }
+}
+
 void mangle_mangleContent(run_t* run, unsigned slow_factor) {
     static void (*const mangleFuncs[])(run_t * run, bool printable) = {
         /* Every *Insert or Expand expands file, so add more Shrink's */
@@ -848,22 +996,7 @@ void mangle_mangleContent(run_t* run, unsigned slow_factor) {
         mangle_Resize(run, /* printable= */ run->global->cfg.only_printable);
     }
 
-    uint64_t changesCnt = run->global->mutate.mutationsPerRun;
-    /* Give it a good shake-up, if it's a slow input */
-    switch (slow_factor) {
-        case 0 ... 2:
-            changesCnt = util_rndGet(1, run->global->mutate.mutationsPerRun);
-            break;
-        case 3 ... 4:
-            changesCnt = HF_MAX(run->global->mutate.mutationsPerRun, 5);
-            break;
-        case 5 ... 9:
-            changesCnt = HF_MAX(run->global->mutate.mutationsPerRun, 7);
-            break;
-        default:
-            changesCnt = HF_MAX(run->global->mutate.mutationsPerRun, 10);
-            break;
-    }
+    uint64_t changesCnt = mangle_changesCnt(run, slow_factor);
 
     if ((util_timeNowMillis() - ATOMIC_GET(run->global->timing.lastCovUpdate)) > 1000) {
         switch (util_rnd64() % 3) {
@@ -885,3 +1018,393 @@ void mangle_mangleContent(run_t* run, unsigned slow_factor) {
 
     wmb();
 }
+
+static uint32_t mangle_fieldGet(const uint8_t* buf, uint32_t width, bool bigEndian) {
+    uint32_t val = 0;
+    for (uint32_t i = 0; i < width; i++) {
+        val |= (uint32_t)buf[bigEndian ? (width - 1 - i) : i] << (i * 8);
+    }
+    return val;
+}
+
+static void mangle_fieldPut(uint8_t* buf, uint32_t width, bool bigEndian, uint32_t val) {
+    for (uint32_t i = 0; i < width; i++) {
+        buf[bigEndian ? (width - 1 - i) : i] = (uint8_t)(val >> (i * 8));
+    }
+}
+
+static void mangle_addField(dynfile_t* dynfile, const inputField_t* field) {
+    if (dynfile->fieldsCnt >= _HF_FIELDS_MAX) {
+        return;
+    }
+    for (size_t i = 0; i < dynfile->fieldsCnt; i++) {
+        if (dynfile->fields[i].off == field->off) {
+            return;
+        }
+    }
+    LOG_D("Input '%s': %s field at offset %" PRIu32 " (width: %" PRIu32 ", %s)", dynfile->path,
+        field->type == _HF_FIELD_LEN ? "length" : "CRC-32", field->off, field->width,
+        field->bigEndian ? "BE" : "LE");
+    dynfile->fields[dynfile->fieldsCnt++] = *field;
+}
+
+/* The checksummed data is looked for right after the field (till EOF), and before it */
+static void mangle_inferCrc32(dynfile_t* dynfile, uint32_t off, bool bigEndian, uint32_t val) {
+    inputField_t field = {
+        .type = _HF_FIELD_CRC32,
+        .off = off,
+        .width = 4,
+        .bigEndian = bigEndian,
+    };
+
+    if ((off + 4) == dynfile->size) {
+        field.atEof = true;
+    }
+
+    uint32_t crc = 0;
+    for (size_t end = off + 4; end < dynfile->size; end++) {
+        crc = util_CRC32(crc, &dynfile->data[end], 1);
+        if (crc == val) {
+            field.start = off + 4;
+            field.end = end + 1;
+            field.toEof = (field.end == dynfile->size);
+            mangle_addField(dynfile, &field);
+            return;
+        }
+    }
+
+    size_t low = (off > _HF_FIELDS_CRC_WINDOW) ? (off - _HF_FIELDS_CRC_WINDOW) : 0;
+    for (size_t start = off; start-- > low;) {
+        if (util_CRC32(0, &dynfile->data[start], off - start) == val) {
+            field.start = start;
+            field.end = off;
+            mangle_addField(dynfile, &field);
+            return;
+        }
+    }
+}
+
+/*
+ * Looks up values, which the target compared as equal to something it computed, in the input. If
+ * such a value relates to the input size, or to a CRC-32 of some of the input's bytes, it's most
+ * likely a field which the target validates
+ */
+void mangle_inferFields(run_t* run, dynfile_t* dynfile) {
+    dynfile->fieldsCnt = 0;
+    if (!run->global->mutate.fixupFields) {
+        return;
+    }
+
+    const feedback_t* fb = run->global->feedback.covFeedbackMap;
+    uint32_t cnt = HF_MIN(ATOMIC_GET(fb->cmpEq[run->fuzzNo].cnt), _HF_CMP_EQ_MAX);
+    for (uint32_t i = 0; i < cnt; i++) {
+        uint32_t val = fb->cmpEq[run->fuzzNo].val[i];
+        /* Wider first, as a 4-byte LE field with a small value also matches as a 2-byte one */
+        for (uint32_t width = 4; width >= 2; width -= 2) {
+            if (width == 2 && val > 0xFFFF) {
+                continue;
+            }
+            for (size_t off = 0; (off + width) <= dynfile->size; off++) {
+                for (int be = 0; be < 2; be++) {
+                    if (mangle_fieldGet(&dynfile->data[off], width, be) != val) {
+                        continue;
+                    }
+                    if (val <= dynfile->size &&
+                        (dynfile->size - val) <= (off + width + _HF_FIELDS_LEN_SLACK)) {
+                        const inputField_t field = {
+                            .type = _HF_FIELD_LEN,
+                            .atEof = ((off + width) == dynfile->size),
+                            .off = off,
+                            .width = width,
+                            .bigEndian = be,
+                            .adj = dynfile->size - val,
+                        };
+                        mangle_addField(dynfile, &field);
+                    } else if (width == 4 && val > 0xFFFF) {
+                        mangle_inferCrc32(dynfile, off, be, val);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Makes length and checksum fields found in the seed input consistent with the mutated input */
+void mangle_fixupFields(run_t* run, const dynfile_t* seed) {
+    if (seed->fieldsCnt == 0) {
+        return;
+    }
+    /* Keep some inputs inconsistent, so the error handling paths are still tested */
+    if ((util_rnd64() % 8) == 0) {
+        return;
+    }
+
+    uint8_t* data = run->dynfile->data;
+    size_t size = run->dynfile->size;
+
+    /* Lengths first, as they might be covered by checksums */
+    for (size_t i = 0; i < seed->fieldsCnt; i++) {
+        const inputField_t* f = &seed->fields[i];
+        if (f->type != _HF_FIELD_LEN || size < f->width || size < f->adj) {
+            continue;
+        }
+        size_t off = f->atEof ? (size - f->width) : f->off;
+        uint64_t val = size - f->adj;
+        if ((off + f->width) > size || (f->width == 2 && val > 0xFFFF)) {
+            continue;
+        }
+        mangle_fieldPut(&data[off], f->width, f->bigEndian, (uint32_t)val);
+    }
+    for (size_t i = 0; i < seed->fieldsCnt; i++) {
+        const inputField_t* f = &seed->fields[i];
+        if (f->type != _HF_FIELD_CRC32 || size < f->width) {
+            continue;
+        }
+        size_t off = f->atEof ? (size - f->width) : f->off;
+        size_t end = f->toEof ? size : f->end;
+        /* Data checksummed up to a trailing field ends where the field starts now */
+        if (f->atEof && f->end == f->off) {
+            end = off;
+        }
+        if ((off + f->width) > size || end > size || f->start >= end) {
+            continue;
+        }
+        /* The field itself can't be checksummed */
+        if (off < end && (off + f->width) > f->start) {
+            continue;
+        }
+        mangle_fieldPut(
+            &data[off], f->width, f->bigEndian, util_CRC32(0, &data[f->start], end - f->start));
+    }
+}
+
+typedef enum {
+    _HF_TOKEN_WORD = 0, /* identifiers, keywords, numbers */
+    _HF_TOKEN_SPACE,
+    _HF_TOKEN_PUNCT, /* every punctuation character is a separate token */
+    _HF_TOKEN_BINARY,
+} tokenClass_t;
+
+static tokenClass_t mangle_tokenClass(uint8_t c) {
+    if (isalnum(c) || c == '_') {
+        return _HF_TOKEN_WORD;
+    }
+    if (isspace(c)) {
+        return _HF_TOKEN_SPACE;
+    }
+    if (isprint(c)) {
+        return _HF_TOKEN_PUNCT;
+    }
+    return _HF_TOKEN_BINARY;
+}
+
+/* Counts a token in the corpus-wide table, which stops accepting new tokens when it's 3/4 full */
+static void mangle_tokenAdd(honggfuzz_t* hfuzz, const uint8_t* tok, size_t len) {
+    uint32_t slot = (uint32_t)util_hash((const char*)tok, len) % _HF_TOKENS_MAX;
+    for (;; slot = (slot + 1) % _HF_TOKENS_MAX) {
+        if (hfuzz->mutate.tokens.tab[slot].len == 0) {
+            break;
+        }
+        if (hfuzz->mutate.tokens.tab[slot].len == len &&
+            memcmp(hfuzz->mutate.tokens.tab[slot].val, tok, len) == 0) {
+            hfuzz->mutate.tokens.tab[slot].cnt++;
+            return;
+        }
+    }
+    if (hfuzz->mutate.tokens.usedCnt >= (_HF_TOKENS_MAX / 4 * 3)) {
+        return;
+    }
+    memcpy(hfuzz->mutate.tokens.tab[slot].val, tok, len);
+    hfuzz->mutate.tokens.tab[slot].len = len;
+    hfuzz->mutate.tokens.tab[slot].cnt = 1;
+    hfuzz->mutate.tokens.used[hfuzz->mutate.tokens.usedCnt++] = slot;
+}
+
+/*
+ * Builds the token index of a new corpus input (once, as it enters the corpus), and accounts its
+ * words and punctuation in the corpus-wide token statistics
+ */
+void mangle_tokenize(run_t* run, dynfile_t* dynfile) {
+    dynfile->tokens = NULL;
+    dynfile->tokensCnt = 0;
+    if (!run->global->mutate.mutateTokens || dynfile->size == 0) {
+        return;
+    }
+
+    uint32_t* tokens = (uint32_t*)util_Malloc(dynfile->size * sizeof(uint32_t));
+    size_t cnt = 0;
+    for (size_t i = 0; i < dynfile->size; i++) {
+        tokenClass_t cls = mangle_tokenClass(dynfile->data[i]);
+        if (cnt == 0 || cls == _HF_TOKEN_PUNCT ||
+            cls != mangle_tokenClass(dynfile->data[tokens[cnt - 1]]) ||
+            (i - tokens[cnt - 1]) >= _HF_TOKEN_MAX_LEN) {
+            tokens[cnt++] = i;
+        }
+    }
+    dynfile->tokens = (uint32_t*)util_Realloc(tokens, cnt * sizeof(uint32_t));
+    dynfile->tokensCnt = cnt;
+
+    MX_SCOPED_RWLOCK_WRITE(&run->global->mutate.tokens.rwlock);
+    for (size_t i = 0; i < cnt; i++) {
+        size_t end = ((i + 1) < cnt) ? dynfile->tokens[i + 1] : dynfile->size;
+        tokenClass_t cls = mangle_tokenClass(dynfile->data[dynfile->tokens[i]]);
+        if (cls == _HF_TOKEN_WORD || cls == _HF_TOKEN_PUNCT) {
+            mangle_tokenAdd(
+                run->global, &dynfile->data[dynfile->tokens[i]], end - dynfile->tokens[i]);
+        }
+    }
+}
+
+typedef struct {
+    const uint8_t* ptr;
+    size_t len;
+} tokenSpan_t;
+
+/* Random span, preferably of the same class as 'cls' */
+static size_t mangle_tokenPick(const tokenSpan_t* spans, size_t cnt, tokenClass_t cls) {
+    size_t idx = util_rndGet(0, cnt - 1);
+    for (unsigned i = 0; i < 8; i++) {
+        if (spans[idx].len && mangle_tokenClass(spans[idx].ptr[0]) == cls) {
+            break;
+        }
+        idx = util_rndGet(0, cnt - 1);
+    }
+    return idx;
+}
+
+/*
+ * Token from the corpus-wide table, of the same class as 'cls' if possible: the more frequent one
+ * out of a few random ones, so common keywords and operators are used more often than rare names
+ */
+static bool mangle_tokenFromCorpus(run_t* run, tokenClass_t cls, tokenSpan_t* span) {
+    MX_SCOPED_RWLOCK_READ(&run->global->mutate.tokens.rwlock);
+
+    size_t usedCnt = run->global->mutate.tokens.usedCnt;
+    if (usedCnt == 0) {
+        return false;
+    }
+    const __typeof__(run->global->mutate.tokens.tab[0])* best = NULL;
+    for (unsigned i = 0; i < 4; i++) {
+        uint32_t slot = run->global->mutate.tokens.used[util_rndGet(0, usedCnt - 1)];
+        const __typeof__(run->global->mutate.tokens.tab[0])* tok =
+            &run->global->mutate.tokens.tab[slot];
+        bool sameCls = (mangle_tokenClass(tok->val[0]) == cls);
+        bool bestSameCls = best && (mangle_tokenClass(best->val[0]) == cls);
+        if (!best || (sameCls && !bestSameCls) ||
+            (sameCls == bestSameCls && tok->cnt > best->cnt)) {
+            best = tok;
+        }
+    }
+    /* Slots are never modified once used (except for counters), so it's safe to keep the ptr */
+    span->ptr = best->val;
+    span->len = best->len;
+    return true;
+}
+
+/*
+ * Mutates the input as a sequence of tokens of the seed, so the result stays lexically valid.
+ * Returns false if the byte-level mutations should be used instead
+ */
+bool mangle_mangleTokens(run_t* run, const dynfile_t* seed) {
+    if (!run->global->mutate.mutateTokens || run->mutationsPerRun == 0U || seed->tokensCnt < 2) {
+        return false;
+    }
+    if (util_rnd64() % 2) {
+        return false;
+    }
+
+    size_t changesCnt = util_rndGet(1, run->mutationsPerRun);
+    size_t cap = seed->tokensCnt + changesCnt;
+    tokenSpan_t* spans = (tokenSpan_t*)util_Malloc(cap * sizeof(tokenSpan_t));
+    defer {
+        free(spans);
+    };
+
+    size_t cnt = seed->tokensCnt;
+    for (size_t i = 0; i < cnt; i++) {
+        size_t end = ((i + 1) < cnt) ? seed->tokens[i + 1] : seed->size;
+        spans[i].ptr = &seed->data[seed->tokens[i]];
+        spans[i].len = end - seed->tokens[i];
+    }
+
+    for (size_t x = 0; x < changesCnt && cnt > 0; x++) {
+        size_t i = util_rndGet(0, cnt - 1);
+        tokenClass_t cls = mangle_tokenClass(spans[i].ptr[0]);
+        switch (util_rndGet(0, 3)) {
+            case 0: { /* Swap with a token of the same class */
+                size_t j = mangle_tokenPick(spans, cnt, cls);
+                tokenSpan_t tmp = spans[i];
+                spans[i] = spans[j];
+                spans[j] = tmp;
+            } break;
+            case 1: { /* Duplicate */
+                size_t j = util_rndGet(0, cnt);
+                memmove(&spans[j + 1], &spans[j], (cnt - j) * sizeof(tokenSpan_t));
+                spans[j] = spans[i < j ? i : i + 1];
+                cnt++;
+            } break;
+            case 2: /* Delete */
+                memmove(&spans[i], &spans[i + 1], (cnt - i - 1) * sizeof(tokenSpan_t));
+                cnt--;
+                break;
+            default: /* Replace with a token seen in the corpus */
+                mangle_tokenFromCorpus(run, cls, &spans[i]);
+                break;
+        }
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        size_t len = HF_MIN(spans[i].len, run->global->mutate.maxInputSz - size);
+        memcpy(&run->dynfile->data[size], spans[i].ptr, len);
+        size += len;
+    }
+    input_setSize(run, size);
+
+    return true;
+}
+
+/*
+ * Saves the coverage sketch of a new corpus input, and finds its splice anchors: all windows of
+ * smaller inputs, and for bigger ones only those with hash matching the mask, so that the same
+ * content is an anchor in every input it appears in
+ */
+void mangle_spliceIndex(run_t* run, dynfile_t* dynfile) {
+    dynfile->anchors = NULL;
+    dynfile->anchorsCnt = 0;
+    dynfile->anchorsMask = 0;
+    if (!run->global->mutate.spliceAligned) {
+        memset(dynfile->covSig, '\0', sizeof(dynfile->covSig));
+        return;
+    }
+
+    memcpy(dynfile->covSig, run->global->feedback.covFeedbackMap->covSig[run->fuzzNo],
+        sizeof(dynfile->covSig));
+
+    if (dynfile->size < sizeof(uint32_t)) {
+        return;
+    }
+    while ((dynfile->size / ((size_t)dynfile->anchorsMask + 1)) > _HF_SPLICE_ANCHORS_MAX) {
+        dynfile->anchorsMask = (dynfile->anchorsMask << 1) | 1;
+    }
+
+    size_t end = dynfile->size - sizeof(uint32_t) + 1;
+    spliceAnchor_t* anchors = NULL;
+    for (size_t off = 0; off < end && dynfile->anchorsCnt < _HF_SPLICE_ANCHORS_MAX; off++) {
+        uint32_t hash = mangle_windowHash(&dynfile->data[off]);
+        if (hash == 0 || (hash & dynfile->anchorsMask) != 0) {
+            continue;
+        }
+        if ((dynfile->anchorsCnt % 64) == 0) {
+            anchors = (spliceAnchor_t*)util_Realloc(
+                anchors, (dynfile->anchorsCnt + 64) * sizeof(spliceAnchor_t));
+        }
+        anchors[dynfile->anchorsCnt].hash = hash;
+        anchors[dynfile->anchorsCnt].off = off;
+        dynfile->anchorsCnt++;
+    }
+    if (anchors) {
+        qsort(anchors, dynfile->anchorsCnt, sizeof(spliceAnchor_t), mangle_anchorCmp);
+    }
+    dynfile->anchors = anchors;
+}
@@ -26,6 +26,12 @@
 
 #include "honggfuzz.h"
 
+extern unsigned mangle_changesCnt(run_t* run, unsigned slow_factor);
 extern void mangle_mangleContent(run_t* run, unsigned slow_factor);
+extern void mangle_inferFields(run_t* run, dynfile_t* dynfile);
+extern void mangle_fixupFields(run_t* run, const dynfile_t* seed);
+extern void mangle_tokenize(run_t* run, dynfile_t* dynfile);
+extern bool mangle_mangleTokens(run_t* run, const dynfile_t* seed);
+extern void mangle_spliceIndex(run_t* run, dynfile_t* dynfile);
 
 #endif
@@ -204,3 +204,6 @@ bool arch_archThreadInit(run_t* run) {
 
     return true;
 }
+
+void arch_archThreadDestroy(run_t* run HF_ATTR_UNUSED) {
+}
@@ -51,6 +51,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "input.h"
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
@@ -276,6 +277,8 @@ static void arch_traceAnalyzeData(run_t* run, pid_t pid) {
 static void arch_traceSaveData(run_t* run, pid_t pid) {
     register_t pc = 0;
 
+    input_syncChildMutation(run);
+
     /* Local copy since flag is overridden for some crashes */
     bool saveUnique = run->global->io.saveUnique;
 
@@ -363,6 +366,7 @@ static void arch_traceSaveData(run_t* run, pid_t pid) {
 
     /* Increase global crashes counter */
     ATOMIC_POST_INC(run->global->cnts.crashesCnt);
+    run->crashed = true;
 
     /*
      * Check if backtrace contains whitelisted symbol. Whitelist overrides
@@ -546,8 +550,9 @@ void arch_traceAnalyze(run_t* run, int status, pid_t pid) {
             /*
              * If fuzzer worker is from core fuzzing process run full
              * analysis. Otherwise just unwind and get stack hash signature.
+             * With a sanitizer build, it's the one which saves crashes.
              */
-            if (run->mainWorker) {
+            if (run->mainWorker && (!run->global->sanitizer.argc || run->isSanitizerBuild)) {
                 arch_traceSaveData(run, pid);
             } else {
                 arch_traceAnalyzeData(run, pid);
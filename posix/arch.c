@@ -42,6 +42,7 @@
 #include <unistd.h>
 
 #include "fuzz.h"
+#include "input.h"
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
@@ -108,10 +109,13 @@ static void arch_analyzeSignal(run_t* run, pid_t pid, int status) {
 
     int termsig = WTERMSIG(status);
     LOG_D("Process (pid %d) killed by signal %d '%s'", pid, termsig, strsignal(termsig));
+    input_syncChildMutation(run);
     if (!arch_sigs[termsig].important) {
         LOG_D("It's not that important signal, skipping");
         return;
     }
+    /* Duplicates of already saved crashes are not counted below, but it's a crash nonetheless */
+    run->crashed = true;
 
     funcs_t* funcs = util_Calloc(_HF_MAX_FUNCS * sizeof(funcs_t));
     defer {
@@ -218,7 +222,7 @@ static bool arch_checkWait(run_t* run) {
 
         if (pid == run->pid && (WIFEXITED(status) || WIFSIGNALED(status))) {
             if (run->global->exe.persistent) {
-                if (!fuzz_isTerminating()) {
+                if (!fuzz_isTerminating() && run->runState != _HF_RS_RECYCLING) {
                     LOG_W("Persistent mode: pid=%d exited with status: %s", (int)run->pid,
                         subproc_StatusToStr(status, statusStr, sizeof(statusStr)));
                 }
@@ -273,3 +277,6 @@ bool arch_archInit(honggfuzz_t* hfuzz HF_ATTR_UNUSED) {
 bool arch_archThreadInit(run_t* fuzzer HF_ATTR_UNUSED) {
     return true;
 }
+
+void arch_archThreadDestroy(run_t* fuzzer HF_ATTR_UNUSED) {
+}
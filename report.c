@@ -28,8 +28,11 @@
 #include <inttypes.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "libhfcommon/common.h"
 #include "libhfcommon/log.h"
@@ -51,6 +54,8 @@ static void report_printdynFileMethod(run_t* run) {
             dprintf(reportFD, "BTS_EDGE_COUNT ");
         if (run->global->feedback.dynFileMethod & _HF_DYNFILE_IPT_BLOCK)
             dprintf(reportFD, "IPT_BLOCK_COUNT ");
+        if (run->global->feedback.dynFileMethod & _HF_DYNFILE_BP_BLOCK)
+            dprintf(reportFD, "BP_BLOCK_COUNT ");
 
         dprintf(reportFD, "\n");
     }
@@ -162,3 +167,57 @@ void report_appendReport(pid_t pid, run_t* run, funcs_t* funcs, size_t funcCnt,
 
     return;
 }
+
+static int report_replayCmp(const void* a, const void* b) {
+    const replayResult_t* ra = (const replayResult_t*)a;
+    const replayResult_t* rb = (const replayResult_t*)b;
+    return strcmp(ra->name, rb->name);
+}
+
+/*
+ * Writes per-file results of the replay mode (sorted by name, so they don't depend on the
+ * scheduling of fuzzing threads) and the summary. Returns false if they couldn't be written, or
+ * if any input crashed or timed out
+ */
+bool report_saveReplay(honggfuzz_t* hfuzz) {
+    int fd = STDOUT_FILENO;
+    if (strcmp(hfuzz->replay.resultsFile, "-") != 0) {
+        fd = TEMP_FAILURE_RETRY(
+            open(hfuzz->replay.resultsFile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if (fd == -1) {
+            PLOG_E("Couldn't open('%s') for writing", hfuzz->replay.resultsFile);
+            return false;
+        }
+    }
+    defer {
+        if (fd != STDOUT_FILENO) {
+            close(fd);
+        }
+    };
+
+    qsort(hfuzz->replay.results, hfuzz->replay.resultsCnt, sizeof(replayResult_t),
+        report_replayCmp);
+
+    size_t crashes = 0, tmOuts = 0;
+    for (size_t i = 0; i < hfuzz->replay.resultsCnt; i++) {
+        const replayResult_t* r = &hfuzz->replay.results[i];
+        crashes += r->crashed ? 1 : 0;
+        tmOuts += r->tmOut ? 1 : 0;
+        dprintf(fd, "%s\t%zu\t%" PRIu64 "ms\t%s\n", r->name, r->size, r->timeMillis,
+            r->crashed ? "CRASH" : (r->tmOut ? "TIMEOUT" : "OK"));
+        free(r->name);
+    }
+
+    LOG_I("Replay files:%zu crashes:%zu timeouts:%zu coverage (i/b/h/e/p/c): %" PRIu64 "/%" PRIu64
+          "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64 " guard_nb:%" PRIu64,
+        hfuzz->replay.resultsCnt, crashes, tmOuts, hfuzz->linux.hwCnts.cpuInstrCnt,
+        hfuzz->linux.hwCnts.cpuBranchCnt, hfuzz->linux.hwCnts.bbCnt,
+        hfuzz->linux.hwCnts.softCntEdge, hfuzz->linux.hwCnts.softCntPc,
+        hfuzz->linux.hwCnts.softCntCmp, ATOMIC_GET(hfuzz->feedback.covFeedbackMap->guardNb));
+
+    free(hfuzz->replay.results);
+    hfuzz->replay.results = NULL;
+    hfuzz->replay.resultsCnt = 0;
+
+    return (crashes == 0 && tmOuts == 0);
+}
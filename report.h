@@ -30,5 +30,6 @@
 extern void report_saveReport(run_t* run);
 extern void report_appendReport(pid_t pid, run_t* run, funcs_t* funcs, size_t funcCnt, uint64_t pc,
     uint64_t crashAddr, int signo, const char* instr, const char description[HF_STR_LEN]);
+extern bool report_saveReplay(honggfuzz_t* hfuzz);
 
 #endif
@@ -33,6 +33,9 @@
 #include <string.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
+#if defined(_HF_ARCH_LINUX)
+#include <sys/syscall.h>
+#endif /* defined(_HF_ARCH_LINUX) */
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -40,10 +43,14 @@
 
 #include "arch.h"
 #include "fuzz.h"
+#include "input.h"
 #include "libhfcommon/common.h"
 #include "libhfcommon/files.h"
 #include "libhfcommon/log.h"
 #include "libhfcommon/util.h"
+#if defined(_HF_ARCH_LINUX)
+#include "linux/cgroup.h"
+#endif /* defined(_HF_ARCH_LINUX) */
 
 extern char** environ;
 
@@ -123,8 +130,65 @@ const char* subproc_StatusToStr(int status, char* str, size_t len) {
     return str;
 }
 
+/*
+ * Signals sent through a pidfd can't hit an unrelated process, which reused the pid of an already
+ * reaped child
+ */
+void subproc_kill(run_t* run, int sig) {
+#if defined(_HF_ARCH_LINUX)
+    /* With --linux_cgroup, SIGKILL goes to everything the process has started as well */
+    if (sig == SIGKILL && arch_cgroupKill(run)) {
+        return;
+    }
+#endif /* defined(_HF_ARCH_LINUX) */
+#if defined(_HF_ARCH_LINUX) && defined(__NR_pidfd_send_signal)
+    if (run->linux.pidFd != -1) {
+        if (syscall(__NR_pidfd_send_signal, run->linux.pidFd, sig, NULL, 0) == 0 ||
+            errno == ESRCH) {
+            return;
+        }
+        PLOG_D("pidfd_send_signal(pid=%d, sig=%d)", (int)run->pid, sig);
+    }
+#endif /* defined(_HF_ARCH_LINUX) && defined(__NR_pidfd_send_signal) */
+    kill(run->pid, sig);
+}
+
+/* As subproc_kill(), for processes which are not the current one of a run (e.g. spare ones) */
+static void subproc_killPid(pid_t pid, int sig) {
+#if defined(_HF_ARCH_LINUX) && defined(__NR_pidfd_send_signal)
+    int pidFd = arch_pidFdTake(pid);
+    if (pidFd != -1) {
+        bool sent = (syscall(__NR_pidfd_send_signal, pidFd, sig, NULL, 0) == 0 || errno == ESRCH);
+        close(pidFd);
+        if (sent) {
+            return;
+        }
+    }
+#endif /* defined(_HF_ARCH_LINUX) && defined(__NR_pidfd_send_signal) */
+    kill(pid, sig);
+}
+
 static bool subproc_persistentSendFileIndicator(run_t* run) {
+    feedback_t* fb = run->global->feedback.covFeedbackMap;
     uint64_t len = (uint64_t)run->dynfile->size;
+    if (run->dynfileNo == 1) {
+        len |= _HF_INPUT_ALT_FLAG;
+    }
+    if (run->dynfile->childMangle) {
+        len = (uint64_t)run->dynfile->seedSize | _HF_INPUT_MANGLE_FLAG;
+        fb->childMut[run->fuzzNo].corpusOff =
+            run->dynfile->seedData - run->global->mutate.corpusMap;
+        fb->childMut[run->fuzzNo].maxSize = run->global->mutate.maxInputSz;
+        fb->childMut[run->fuzzNo].seed = run->dynfile->mangleSeed;
+        fb->childMut[run->fuzzNo].changesCnt = run->dynfile->mangleChangesCnt;
+        fb->childMut[run->fuzzNo].printable = run->global->cfg.only_printable;
+    }
+    if (run->dynfile->customMutate) {
+        len |= _HF_INPUT_MUTATE_FLAG;
+        fb->childMut[run->fuzzNo].crossOverLen = run->dynfile->crossOverLen;
+        fb->childMut[run->fuzzNo].size = run->dynfile->size;
+        fb->childMut[run->fuzzNo].seed = util_rnd64();
+    }
     if (!files_sendToSocketNB(run->persistentSock, (uint8_t*)&len, sizeof(len))) {
         PLOG_W("files_sendToSocketNB(len=%zu)", sizeof(len));
         return false;
@@ -137,6 +201,16 @@ static bool subproc_persistentGetReady(run_t* run) {
     if (recv(run->persistentSock, &rcv, sizeof(rcv), MSG_DONTWAIT) != sizeof(rcv)) {
         return false;
     }
+    if (rcv == HFTimeoutTag) {
+        if (!run->tmOutSignaled) {
+            LOG_W("pid=%d took too much time (limit %ld s). The input was stopped by the "
+                  "in-process watchdog",
+                (int)run->pid, (long)run->global->timing.tmOut);
+            run->tmOutSignaled = true;
+            ATOMIC_POST_INC(run->global->cnts.timeoutedCnt);
+        }
+        return true;
+    }
     if (rcv != HFReadyTag) {
         LOG_E("Received invalid message from the persistent process: '%c' (0x%" PRIx8
               ") , expected '%c' (0x%" PRIx8 ")",
@@ -146,6 +220,100 @@ static bool subproc_persistentGetReady(run_t* run) {
     return true;
 }
 
+/* Resident set size of the process, or 0 if it's not known */
+static uint64_t subproc_getRssKiB(pid_t pid) {
+#if defined(_HF_ARCH_LINUX)
+    char fname[PATH_MAX];
+    snprintf(fname, sizeof(fname), "/proc/%d/statm", (int)pid);
+    char buf[256];
+    ssize_t sz = files_readFileToBufMax(fname, (uint8_t*)buf, sizeof(buf) - 1);
+    if (sz <= 0) {
+        return 0;
+    }
+    buf[sz] = '\0';
+
+    unsigned long long pages;
+    if (sscanf(buf, "%*u %llu", &pages) != 1) {
+        LOG_W("Couldn't parse '%s': '%s'", fname, buf);
+        return 0;
+    }
+    return pages * ((uint64_t)sysconf(_SC_PAGESIZE) / 1024U);
+#else
+    (void)pid;
+    return 0;
+#endif /* defined(_HF_ARCH_LINUX) */
+}
+
+/*
+ * Saves inputs which grow the persistent process' memory noticeably (by 1/4) faster than any input
+ * before, since the process was started
+ */
+static void subproc_persistentSaveMemGrowth(run_t* run, uint64_t growthKiB) {
+    uint64_t maxGrowthKiB = run->recycle.maxGrowthKiB;
+    if (growthKiB <= _HF_RECYCLE_RSS_GROWTH_KIB || growthKiB <= (maxGrowthKiB + maxGrowthKiB / 4)) {
+        return;
+    }
+    run->recycle.maxGrowthKiB = growthKiB;
+
+    char fname[PATH_MAX];
+    snprintf(fname, sizeof(fname), "%s/MEMGROWTH.RSS.%" PRIu64 "KiB.%s", run->global->io.workDir,
+        growthKiB, run->global->io.fileExtn);
+    LOG_I("Input grew RSS of pid=%d by %" PRIu64 " KiB, saving it as '%s'", (int)run->pid,
+        growthKiB, fname);
+    input_syncChildMutation(run);
+    if (!files_writeBufToFile(fname, run->dynfile->data, run->dynfile->size,
+            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC)) {
+        LOG_W("Couldn't save the input as '%s'", fname);
+    }
+}
+
+/*
+ * Called after each persistent round. Leaks and fragmentation make persistent processes bigger
+ * and slower over time, so they're restarted once they cross limits set by the user
+ */
+static bool subproc_persistentShouldRecycle(run_t* run) {
+    uint64_t roundUSecs = (uint64_t)(util_timeNowUSecs() - run->recycle.roundStartUSecs);
+    run->recycle.rounds++;
+
+    if (run->global->exe.persistentMaxRss) {
+        uint64_t rssKiB = subproc_getRssKiB(run->pid);
+        if (run->recycle.rssKiB && rssKiB > run->recycle.rssKiB) {
+            subproc_persistentSaveMemGrowth(run, rssKiB - run->recycle.rssKiB);
+        }
+        run->recycle.rssKiB = rssKiB;
+        if (rssKiB > (run->global->exe.persistentMaxRss * 1024U)) {
+            LOG_I("Persistent mode: pid=%d RSS is %" PRIu64 " MiB (limit: %" PRIu64
+                  " MiB), restarting it",
+                (int)run->pid, rssKiB / 1024U, run->global->exe.persistentMaxRss);
+            return true;
+        }
+    }
+
+    if (run->global->exe.persistentMaxSlowdown) {
+        if (run->recycle.rounds <= _HF_RECYCLE_BASE_ROUNDS) {
+            run->recycle.baseUSecs += roundUSecs;
+            if (run->recycle.rounds == _HF_RECYCLE_BASE_ROUNDS) {
+                run->recycle.baseUSecs = HF_MAX(run->recycle.baseUSecs / _HF_RECYCLE_BASE_ROUNDS, 1U);
+                run->recycle.avgUSecs = run->recycle.baseUSecs;
+            }
+            return false;
+        }
+        /* Exponential moving average, so a few slow inputs don't trigger it */
+        run->recycle.avgUSecs = run->recycle.avgUSecs - (run->recycle.avgUSecs / 64U) +
+                                (roundUSecs / 64U);
+        if (run->recycle.rounds > (_HF_RECYCLE_BASE_ROUNDS * 2U) &&
+            run->recycle.avgUSecs >
+                (run->recycle.baseUSecs * run->global->exe.persistentMaxSlowdown)) {
+            LOG_I("Persistent mode: pid=%d takes %" PRIu64 " us per input (initially: %" PRIu64
+                  " us), restarting it",
+                (int)run->pid, run->recycle.avgUSecs, run->recycle.baseUSecs);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool subproc_persistentModeStateMachine(run_t* run) {
     if (!run->global->exe.persistent) {
         return false;
@@ -164,19 +332,31 @@ bool subproc_persistentModeStateMachine(run_t* run) {
                     LOG_E("Could not send the file size indicator to the persistent process. "
                           "Killing the process pid=%d",
                         (int)run->pid);
-                    kill(run->pid, SIGKILL);
+                    subproc_kill(run, SIGKILL);
                     return false;
                 }
                 run->runState = _HF_RS_WAITING_FOR_READY;
+                run->recycle.roundStartUSecs = util_timeNowUSecs();
+                /* The persistent process is busy now, use the time to prepare the next input */
+                fuzz_prepareNextInput(run);
             }; break;
             case _HF_RS_WAITING_FOR_READY: {
                 if (!subproc_persistentGetReady(run)) {
                     return false;
                 }
                 run->runState = _HF_RS_SEND_DATA;
+                if (subproc_persistentShouldRecycle(run)) {
+                    /* The round ends once the reaper has collected the killed process */
+                    ATOMIC_POST_INC(run->global->cnts.recycledCnt);
+                    run->runState = _HF_RS_RECYCLING;
+                    subproc_kill(run, SIGKILL);
+                    return false;
+                }
                 /* The current persistent round is done */
                 return true;
             }; break;
+            case _HF_RS_RECYCLING:
+                return false;
             default:
                 LOG_F("Unknown runState: %d", run->runState);
         }
@@ -184,25 +364,49 @@ bool subproc_persistentModeStateMachine(run_t* run) {
 }
 
 static void subproc_prepareExecvArgs(run_t* run) {
+    int argc = run->global->exe.argc;
+    const char* const* cmdline = run->global->exe.cmdline;
+    if (run->isSanitizerBuild) {
+        argc = run->global->sanitizer.argc;
+        cmdline = run->global->sanitizer.cmdline;
+    }
+
     size_t x = 0;
-    for (x = 0; x < _HF_ARGS_MAX && x < (size_t)run->global->exe.argc; x++) {
-        const char* ph_str = strstr(run->global->exe.cmdline[x], _HF_FILE_PLACEHOLDER);
-        if (!strcmp(run->global->exe.cmdline[x], _HF_FILE_PLACEHOLDER)) {
+    for (x = 0; x < _HF_ARGS_MAX && x < (size_t)argc; x++) {
+        const char* ph_str = strstr(cmdline[x], _HF_FILE_PLACEHOLDER);
+        if (!strcmp(cmdline[x], _HF_FILE_PLACEHOLDER)) {
             run->args[x] = _HF_INPUT_FILE_PATH;
         } else if (ph_str) {
             static __thread char argData[PATH_MAX];
-            snprintf(argData, sizeof(argData), "%.*s%s",
-                (int)(ph_str - run->global->exe.cmdline[x]), run->global->exe.cmdline[x],
+            snprintf(argData, sizeof(argData), "%.*s%s", (int)(ph_str - cmdline[x]), cmdline[x],
                 _HF_INPUT_FILE_PATH);
             run->args[x] = argData;
         } else {
-            run->args[x] = (char*)run->global->exe.cmdline[x];
+            run->args[x] = (char*)cmdline[x];
         }
     }
     run->args[x] = NULL;
 }
 
-static bool subproc_PrepareExecv(run_t* run) {
+/* Input file, as seen by the fuzzed process: _HF_INPUT_FD (and stdin with -s) */
+static bool subproc_bindInputFd(run_t* run, int inputFd) {
+    if (TEMP_FAILURE_RETRY(dup2(inputFd, _HF_INPUT_FD)) == -1) {
+        PLOG_E("dup2('%d', _HF_INPUT_FD='%d')", inputFd, _HF_INPUT_FD);
+        return false;
+    }
+    if (lseek(_HF_INPUT_FD, 0, SEEK_SET) == (off_t)-1) {
+        PLOG_E("lseek(_HF_INPUT_FD=%d, 0, SEEK_SET)", _HF_INPUT_FD);
+        return false;
+    }
+    if (run->global->exe.fuzzStdin && TEMP_FAILURE_RETRY(dup2(inputFd, STDIN_FILENO)) == -1) {
+        PLOG_E("dup2(_HF_INPUT_FD=%d, STDIN_FILENO=%d)", inputFd, STDIN_FILENO);
+        return false;
+    }
+    return true;
+}
+
+/* Spare processes get the input file later, see subproc_spareWaitForInput() */
+static bool subproc_PrepareExecv(run_t* run, bool bindInput) {
     /*
      * The address space limit. If big enough - roughly the size of RAM used
      */
@@ -267,12 +471,25 @@ static bool subproc_PrepareExecv(run_t* run) {
          i++) {
         putenv(run->global->exe.env_ptrs[i]);
     }
-    char fuzzNo[128];
-    snprintf(fuzzNo, sizeof(fuzzNo), "%" PRId32, run->fuzzNo);
-    setenv(_HF_THREAD_NO_ENV, fuzzNo, 1);
+    /* Without it, libhfuzz in the sanitizer build doesn't look for the feedback structures */
+    if (run->isSanitizerBuild) {
+        unsetenv(_HF_THREAD_NO_ENV);
+    } else {
+        char fuzzNo[128];
+        snprintf(fuzzNo, sizeof(fuzzNo), "%" PRId32, run->fuzzNo);
+        setenv(_HF_THREAD_NO_ENV, fuzzNo, 1);
+    }
+    char maxInputSz[128];
+    snprintf(maxInputSz, sizeof(maxInputSz), "%zu", run->global->mutate.maxInputSz);
+    setenv(_HF_INPUT_MAX_SIZE_ENV, maxInputSz, 1);
     if (run->global->exe.netDriver) {
         setenv(_HF_THREAD_NETDRIVER_ENV, "1", 1);
     }
+    if (run->global->exe.persistentWatchdog) {
+        char tmOutMSec[128];
+        snprintf(tmOutMSec, sizeof(tmOutMSec), "%ld", (long)run->global->timing.tmOut * 1000L);
+        setenv(_HF_WATCHDOG_ENV, tmOutMSec, 1);
+    }
 
     /* Make sure it's a new process group / session, so waitpid can wait for -(run->pid) */
     setsid();
@@ -281,34 +498,49 @@ static bool subproc_PrepareExecv(run_t* run) {
         /* close_stdout= */ run->global->exe.nullifyStdio,
         /* close_stderr= */ run->global->exe.nullifyStdio);
 
-    /* The coverage bitmap/feedback structure */
-    if (TEMP_FAILURE_RETRY(dup2(run->global->feedback.covFeedbackFd, _HF_COV_BITMAP_FD)) == -1) {
+    /*
+     * The coverage bitmap/feedback structure. The sanitizer build doesn't get it, as its
+     * instrumentation differs from the one of the main binary
+     */
+    if (!run->isSanitizerBuild &&
+        TEMP_FAILURE_RETRY(dup2(run->global->feedback.covFeedbackFd, _HF_COV_BITMAP_FD)) == -1) {
         PLOG_E("dup2(%d, _HF_COV_BITMAP_FD=%d)", run->global->feedback.covFeedbackFd,
             _HF_COV_BITMAP_FD);
         return false;
     }
     /* The const comparison bitmap/feedback structure */
-    if (run->global->feedback.cmpFeedback &&
+    if (run->global->feedback.cmpFeedback && !run->isSanitizerBuild &&
         TEMP_FAILURE_RETRY(dup2(run->global->feedback.cmpFeedbackFd, _HF_CMP_BITMAP_FD)) == -1) {
         PLOG_E("dup2(%d, _HF_CMP_BITMAP_FD=%d)", run->global->feedback.cmpFeedbackFd,
             _HF_CMP_BITMAP_FD);
         return false;
     }
 
+    /* The corpus, which the persistent process creates inputs from (--persistent_mangle) */
+    if (run->global->mutate.childMangle && !run->isSanitizerBuild &&
+        TEMP_FAILURE_RETRY(dup2(run->global->mutate.corpusFd, _HF_CORPUS_FD)) == -1) {
+        PLOG_E("dup2(%d, _HF_CORPUS_FD=%d)", run->global->mutate.corpusFd, _HF_CORPUS_FD);
+        return false;
+    }
+
     /* Do not try to handle input files with socketfuzzer */
-    if (!run->global->socketFuzzer.enabled) {
-        /* The input file to _HF_INPUT_FD */
-        if (TEMP_FAILURE_RETRY(dup2(run->dynfile->fd, _HF_INPUT_FD)) == -1) {
-            PLOG_E("dup2('%d', _HF_INPUT_FD='%d')", run->dynfile->fd, _HF_INPUT_FD);
-            return false;
+    if (!run->global->socketFuzzer.enabled && bindInput) {
+        /*
+         * The input file to _HF_INPUT_FD. The persistent process gets both input buffers, and is
+         * told with each size indicator which one to use
+         */
+        int inputFd = run->dynfile->fd;
+        if (run->global->exe.persistent && run->dynfileNo == 1) {
+            inputFd = run->dynfileNext->fd;
         }
-        if (lseek(_HF_INPUT_FD, 0, SEEK_SET) == (off_t)-1) {
-            PLOG_E("lseek(_HF_INPUT_FD=%d, 0, SEEK_SET)", _HF_INPUT_FD);
-            return false;
+        if (run->global->exe.persistent && run->dynfileNext) {
+            int altFd = (run->dynfileNo == 1) ? run->dynfile->fd : run->dynfileNext->fd;
+            if (TEMP_FAILURE_RETRY(dup2(altFd, _HF_INPUT_ALT_FD)) == -1) {
+                PLOG_E("dup2('%d', _HF_INPUT_ALT_FD='%d')", altFd, _HF_INPUT_ALT_FD);
+                return false;
+            }
         }
-        if (run->global->exe.fuzzStdin &&
-            TEMP_FAILURE_RETRY(dup2(run->dynfile->fd, STDIN_FILENO)) == -1) {
-            PLOG_E("dup2(_HF_INPUT_FD=%d, STDIN_FILENO=%d)", run->dynfile->fd, STDIN_FILENO);
+        if (!subproc_bindInputFd(run, inputFd)) {
             return false;
         }
     }
@@ -334,11 +566,178 @@ static bool subproc_PrepareExecv(run_t* run) {
     return true;
 }
 
+/*
+ * Spare processes (--linux_spare_children) are forked in advance, while the fuzzed process runs,
+ * and wait right before execve() for the input file descriptor, which is passed to them (as the
+ * input buffers of the thread are swapped) only once the input is ready
+ */
+static bool subproc_useSpares(run_t* run) {
+#if defined(_HF_ARCH_LINUX)
+    return run->global->linux.spareChildren && !run->global->exe.persistent &&
+           !run->isSanitizerBuild && !run->global->socketFuzzer.enabled;
+#else
+    return false;
+#endif /* defined(_HF_ARCH_LINUX) */
+}
+
+static bool subproc_spareSendInput(int sock, int fd) {
+    char c = 'I';
+    struct iovec iov = {
+        .iov_base = &c,
+        .iov_len = sizeof(c),
+    };
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl = {};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = ctrl.buf,
+        .msg_controllen = sizeof(ctrl.buf),
+    };
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    return (TEMP_FAILURE_RETRY(sendmsg(sock, &msg, MSG_NOSIGNAL)) == (ssize_t)sizeof(c));
+}
+
+/* Blocks until the input file descriptor is received, returns false if the parent gave up on it */
+static bool subproc_spareWaitForInput(run_t* run, int sock) {
+    char c;
+    struct iovec iov = {
+        .iov_base = &c,
+        .iov_len = sizeof(c),
+    };
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl = {};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = ctrl.buf,
+        .msg_controllen = sizeof(ctrl.buf),
+    };
+    if (TEMP_FAILURE_RETRY(recvmsg(sock, &msg, MSG_CMSG_CLOEXEC)) != (ssize_t)sizeof(c)) {
+        return false;
+    }
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        LOG_E("No input file descriptor received");
+        return false;
+    }
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+    bool ret = subproc_bindInputFd(run, fd);
+    close(fd);
+    return ret;
+}
+
+static bool subproc_spareNew(run_t* run) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == -1) {
+        PLOG_W("socketpair(AF_UNIX, SOCK_STREAM, 0, sv)");
+        return false;
+    }
+
+    pid_t pid = arch_fork(run);
+    if (pid == -1) {
+        PLOG_W("Couldn't fork a spare process");
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    /* The child process, see subproc_New() */
+    if (!pid) {
+        alarm(1);
+        signal(SIGALRM, SIG_DFL);
+        close(sv[0]);
+
+        if (!subproc_PrepareExecv(run, /* bindInput= */ false)) {
+            LOG_E("subproc_PrepareExecv() failed");
+            _exit(EXIT_FAILURE);
+        }
+        /* Spare processes can wait for their input longer than the alarm() guard allows */
+        alarm(0);
+        if (!subproc_spareWaitForInput(run, sv[1])) {
+            _exit(EXIT_SUCCESS);
+        }
+        alarm(1);
+        close(sv[1]);
+
+        if (!arch_launchChild(run)) {
+            LOG_E("Error launching child process");
+            kill(run->global->threads.mainPid, SIGTERM);
+            _exit(1);
+        }
+        abort();
+    }
+
+    close(sv[1]);
+    run->spares[run->sparesCnt].pid = pid;
+    run->spares[run->sparesCnt].sock = sv[0];
+    run->sparesCnt++;
+    LOG_D("Forked a spare process, pid=%d, thread: %" PRId32, (int)pid, run->fuzzNo);
+    return true;
+}
+
+/* Takes the most recently forked spare process, and passes the current input to it */
+static bool subproc_spareRelease(run_t* run) {
+    while (run->sparesCnt > 0) {
+        run->sparesCnt--;
+        pid_t pid = run->spares[run->sparesCnt].pid;
+        int sock = run->spares[run->sparesCnt].sock;
+        bool sent = subproc_spareSendInput(sock, run->dynfile->fd);
+        close(sock);
+        if (sent) {
+            run->pid = pid;
+            return true;
+        }
+        LOG_W("Couldn't pass the input to the spare process pid=%d", (int)pid);
+        subproc_killPid(pid, SIGKILL);
+    }
+    return false;
+}
+
+/* Called while the fuzzed process is busy with the current input */
+void subproc_prepareSpares(run_t* run) {
+    if (!subproc_useSpares(run) || fuzz_isTerminating()) {
+        return;
+    }
+#if defined(_HF_ARCH_LINUX)
+    while (run->sparesCnt < run->global->linux.spareChildren) {
+        if (!subproc_spareNew(run)) {
+            return;
+        }
+    }
+#endif /* defined(_HF_ARCH_LINUX) */
+}
+
+void subproc_destroySpares(run_t* run) {
+    for (size_t i = 0; i < run->sparesCnt; i++) {
+        close(run->spares[i].sock);
+        subproc_killPid(run->spares[i].pid, SIGKILL);
+        TEMP_FAILURE_RETRY(waitpid(run->spares[i].pid, NULL, 0));
+    }
+    run->sparesCnt = 0;
+}
+
 static bool subproc_New(run_t* run) {
     if (run->pid) {
         return true;
     }
 
+    if (subproc_useSpares(run) && subproc_spareRelease(run)) {
+        LOG_D("Released a spare process, pid=%d, thread: %" PRId32, (int)run->pid, run->fuzzNo);
+        arch_prepareParentAfterFork(run);
+        return true;
+    }
+
     int sv[2];
     if (run->global->exe.persistent) {
         if (run->persistentSock != -1) {
@@ -388,7 +787,7 @@ static bool subproc_New(run_t* run) {
             close(sv[1]);
         }
 
-        if (!subproc_PrepareExecv(run)) {
+        if (!subproc_PrepareExecv(run, /* bindInput= */ true)) {
             LOG_E("subproc_PrepareExecv() failed");
             exit(EXIT_FAILURE);
         }
@@ -414,30 +813,43 @@ static bool subproc_New(run_t* run) {
     if (run->global->exe.persistent) {
         close(sv[1]);
         run->runState = _HF_RS_WAITING_FOR_INITIAL_READY;
+        memset(&run->recycle, 0, sizeof(run->recycle));
         LOG_I("Persistent mode: Launched new persistent pid=%d", (int)run->pid);
     }
 
     return true;
 }
 
-bool subproc_Run(run_t* run) {
+/* Launches the process (if it's not running already), and lets it run with the current input */
+bool subproc_Start(run_t* run) {
+    run->timeExecStartedMillis = util_timeNowMillis();
     if (!subproc_New(run)) {
         LOG_E("subproc_New()");
         return false;
     }
 
     arch_prepareParent(run);
-    arch_reapChild(run);
+    return true;
+}
 
+/* Called once the process has finished processing the current input */
+void subproc_Finish(run_t* run) {
     int64_t diffMillis = util_timeNowMillis() - run->timeStartedMillis;
 
-    {
-        static pthread_mutex_t local_mutex = PTHREAD_MUTEX_INITIALIZER;
-        MX_SCOPED_LOCK(&local_mutex);
-        if (diffMillis >= ATOMIC_GET(run->global->timing.timeOfLongestUnitInMilliseconds)) {
-            ATOMIC_SET(run->global->timing.timeOfLongestUnitInMilliseconds, diffMillis);
-        }
+    static pthread_mutex_t local_mutex = PTHREAD_MUTEX_INITIALIZER;
+    MX_SCOPED_LOCK(&local_mutex);
+    if (diffMillis >= ATOMIC_GET(run->global->timing.timeOfLongestUnitInMilliseconds)) {
+        ATOMIC_SET(run->global->timing.timeOfLongestUnitInMilliseconds, diffMillis);
     }
+}
+
+bool subproc_Run(run_t* run) {
+    if (!subproc_Start(run)) {
+        return false;
+    }
+
+    arch_reapChild(run);
+    subproc_Finish(run);
 
     return true;
 }
@@ -448,6 +860,15 @@ uint8_t subproc_System(run_t* run, const char* const argv[]) {
         PLOG_E("Couldn't fork");
         return 255;
     }
+#if defined(_HF_ARCH_LINUX)
+    /* It's only waited for */
+    if (pid) {
+        int pidFd = arch_pidFdTake(pid);
+        if (pidFd != -1) {
+            close(pidFd);
+        }
+    }
+#endif /* defined(_HF_ARCH_LINUX) */
     if (!pid) {
         logMutexReset();
 
@@ -508,11 +929,15 @@ void subproc_checkTimeLimit(run_t* run) {
 
     int64_t curMillis = util_timeNowMillis();
     int64_t diffMillis = curMillis - run->timeStartedMillis;
+    /* Give the in-process watchdog a chance to stop the input first */
+    if (run->global->exe.persistentWatchdog) {
+        diffMillis -= _HF_WATCHDOG_GRACE_MSEC;
+    }
 
     if (run->tmOutSignaled && (diffMillis > ((run->global->timing.tmOut + 1) * 1000))) {
         /* Has this instance been already signaled due to timeout? Just, SIGKILL it */
         LOG_W("pid=%d has already been signaled due to timeout. Killing it with SIGKILL", run->pid);
-        kill(run->pid, SIGKILL);
+        subproc_kill(run, SIGKILL);
         return;
     }
 
@@ -522,19 +947,30 @@ void subproc_checkTimeLimit(run_t* run) {
             (long)run->global->timing.tmOut,
             run->global->timing.tmoutVTALRM ? "SIGVTALRM" : "SIGKILL");
         if (run->global->timing.tmoutVTALRM) {
-            kill(run->pid, SIGVTALRM);
+            subproc_kill(run, SIGVTALRM);
         } else {
-            kill(run->pid, SIGKILL);
+            subproc_kill(run, SIGKILL);
         }
         ATOMIC_POST_INC(run->global->cnts.timeoutedCnt);
     }
 }
 
 void subproc_checkTermination(run_t* run) {
-    if (fuzz_isTerminating()) {
-        LOG_D("Killing pid=%d", (int)run->pid);
-        kill(run->pid, SIGKILL);
+    if (!fuzz_isTerminating()) {
+        return;
+    }
+    /*
+     * The sanitizer build and the verifier still have to confirm crashes found before, but only
+     * within the timeout (-t), so a hanging replay doesn't block the exit
+     */
+    if (run->isSanitizerBuild || run->isVerifier) {
+        int64_t diffMillis = util_timeNowMillis() - run->timeStartedMillis;
+        if (diffMillis <= (run->global->timing.tmOut * 1000)) {
+            return;
+        }
     }
+    LOG_D("Killing pid=%d", (int)run->pid);
+    subproc_kill(run, SIGKILL);
 }
 
 bool subproc_runThread(
@@ -37,14 +37,24 @@ extern const char* subproc_StatusToStr(int status, char* str, size_t len);
 
 extern bool subproc_Run(run_t* run);
 
+extern bool subproc_Start(run_t* run);
+
+extern void subproc_Finish(run_t* run);
+
 extern bool subproc_persistentModeStateMachine(run_t* run);
 
 extern uint8_t subproc_System(run_t* run, const char* const argv[]);
 
+extern void subproc_kill(run_t* run, int sig);
+
 extern void subproc_checkTimeLimit(run_t* run);
 
 extern void subproc_checkTermination(run_t* run);
 
+extern void subproc_prepareSpares(run_t* run);
+
+extern void subproc_destroySpares(run_t* run);
+
 bool subproc_runThread(
     honggfuzz_t* hfuzz, pthread_t* thread, void* (*thread_func)(void*), bool joinable);
 